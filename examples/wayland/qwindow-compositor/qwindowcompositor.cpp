@@ -66,6 +66,7 @@ public:
     BufferAttacher()
         : QWaylandBufferAttacher()
         , shmTex(0)
+        , attachCount(0)
     {
     }
 
@@ -86,6 +87,7 @@ public:
         }
 
         bufferRef = ref;
+        ++attachCount;
 
         if (bufferRef) {
             if (bufferRef.isShm()) {
@@ -114,6 +116,7 @@ public:
 
     QOpenGLTexture *shmTex;
     QWaylandBufferRef bufferRef;
+    int attachCount;
     GLuint texture;
 };
 
@@ -126,8 +129,7 @@ QWindowCompositor::QWindowCompositor(CompositorWindow *window)
     , m_draggingWindow(0)
     , m_dragKeyIsPressed(false)
     , m_cursorSurface(0)
-    , m_cursorHotspotX(0)
-    , m_cursorHotspotY(0)
+    , m_cursorAttachCount(0)
     , m_modifiers(Qt::NoModifier)
 {
     m_window->makeCurrent();
@@ -144,7 +146,8 @@ QWindowCompositor::QWindowCompositor(CompositorWindow *window)
 
     setRetainedSelectionEnabled(true);
 
-    createOutput(window, "", "");
+    QWaylandOutput *output = createOutput(window, "", "");
+    connect(output, &QWaylandOutput::cursorChanged, this, &QWindowCompositor::updateCursor);
     addDefaultShell();
 }
 
@@ -265,15 +268,25 @@ void QWindowCompositor::sendExpose()
     surface->sendOnScreenVisibilityChange(true);
 }
 
-void QWindowCompositor::updateCursor(bool hasBuffer)
+void QWindowCompositor::updateCursor()
 {
-    Q_UNUSED(hasBuffer)
-    if (!m_cursorSurface)
+    // The cursor is drawn by the window system, so pointer motion needs
+    // neither a new cursor nor a render, only a new surface, hotspot or buffer
+    QWaylandOutput *output = static_cast<QWaylandOutput *>(sender());
+    QWaylandSurface *surface = output->cursorSurface();
+    if (!surface)
         return;
 
-    QImage image = static_cast<BufferAttacher *>(m_cursorSurface->bufferAttacher())->image();
+    BufferAttacher *attacher = static_cast<BufferAttacher *>(surface->bufferAttacher());
+    if (surface == m_cursorSurface && output->cursorHotspot() == m_cursorHotspot
+            && attacher->attachCount == m_cursorAttachCount)
+        return;
+
+    m_cursorSurface = surface;
+    m_cursorHotspot = output->cursorHotspot();
+    m_cursorAttachCount = attacher->attachCount;
 
-    QCursor cursor(QPixmap::fromImage(image), m_cursorHotspotX, m_cursorHotspotY);
+    QCursor cursor(QPixmap::fromImage(attacher->image()), m_cursorHotspot.x(), m_cursorHotspot.y());
     static bool cursorIsSet = false;
     if (cursorIsSet) {
         QGuiApplication::changeOverrideCursor(cursor);
@@ -290,14 +303,10 @@ QPointF QWindowCompositor::toView(QWaylandSurfaceView *view, const QPointF &pos)
 
 void QWindowCompositor::setCursorSurface(QWaylandSurface *surface, int hotspotX, int hotspotY)
 {
-    if ((m_cursorSurface != surface) && surface)
-        connect(surface, SIGNAL(configure(bool)), this, SLOT(updateCursor(bool)));
+    if (surface && !surface->bufferAttacher())
+        surface->setBufferAttacher(new BufferAttacher);
 
-    m_cursorSurface = surface;
-    m_cursorHotspotX = hotspotX;
-    m_cursorHotspotY = hotspotY;
-    if (m_cursorSurface && !m_cursorSurface->bufferAttacher())
-        m_cursorSurface->setBufferAttacher(new BufferAttacher);
+    QWaylandCompositor::setCursorSurface(surface, hotspotX, hotspotY);
 }
 
 QWaylandSurfaceView *QWindowCompositor::viewAt(const QPointF &point, QPointF *local)
@@ -305,10 +314,10 @@ QWaylandSurfaceView *QWindowCompositor::viewAt(const QPointF &point, QPointF *lo
     for (int i = m_surfaces.size() - 1; i >= 0; --i) {
         QWaylandSurface *surface = m_surfaces.at(i);
         foreach (QWaylandSurfaceView *view, surface->views()) {
-            QRectF geo(view->pos(), surface->size());
-            if (geo.contains(point)) {
+            const QPointF pos = toView(view, point);
+            if (surface->inputRegionContains(pos)) {
                 if (local)
-                    *local = toView(view, point);
+                    *local = pos;
                 return view;
             }
         }
@@ -86,7 +86,7 @@ protected:
 
 private slots:
     void sendExpose();
-    void updateCursor(bool hasBuffer);
+    void updateCursor();
 
 private:
     void drawSubSurface(const QPoint &offset, QWaylandSurface *surface);
@@ -106,8 +106,8 @@ private:
 
     //Cursor
     QWaylandSurface *m_cursorSurface;
-    int m_cursorHotspotX;
-    int m_cursorHotspotY;
+    QPoint m_cursorHotspot;
+    int m_cursorAttachCount;
 
     Qt::KeyboardModifiers m_modifiers;
 };
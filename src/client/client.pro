@@ -76,6 +76,7 @@ SOURCES +=  qwaylandintegration.cpp \
             qwaylandqtkey.cpp \
             ../shared/qwaylandmimehelper.cpp \
             ../shared/qwaylandxkb.cpp \
+            ../shared/qwaylandpropertycodec.cpp \
             qwaylandabstractdecoration.cpp \
             qwaylanddecorationfactory.cpp \
             qwaylanddecorationplugin.cpp \
@@ -109,6 +110,7 @@ HEADERS +=  qwaylandintegration_p.h \
             qwaylandqtkey_p.h \
             ../shared/qwaylandmimehelper.h \
             ../shared/qwaylandxkb.h \
+            ../shared/qwaylandpropertycodec.h \
             qwaylandabstractdecoration_p.h \
             qwaylanddecorationfactory_p.h \
             qwaylanddecorationplugin_p.h \
@@ -38,6 +38,7 @@
 #include "qwaylandscreen_p.h"
 #include "qwaylandshmbackingstore_p.h"
 
+#include <QtGui/QBitmap>
 #include <QtGui/QImageReader>
 #include <QDebug>
 
@@ -47,28 +48,55 @@ QT_BEGIN_NAMESPACE
 
 namespace QtWaylandClient {
 
+// Number of bitmap and pixmap cursors kept uploaded in SHM buffers
+static const int MaxCursorBuffers = 8;
+
 QWaylandCursor::QWaylandCursor(QWaylandScreen *screen)
     : mDisplay(screen->display())
+    , mScreen(screen)
 {
     //TODO: Make wl_cursor_theme_load arguments configurable here
-    QByteArray cursorTheme = qgetenv("XCURSOR_THEME");
-    if (cursorTheme.isEmpty())
-        cursorTheme = QByteArray("default");
+    mCursorThemeName = qgetenv("XCURSOR_THEME");
+    if (mCursorThemeName.isEmpty())
+        mCursorThemeName = QByteArray("default");
     QByteArray cursorSizeFromEnv = qgetenv("XCURSOR_SIZE");
     bool hasCursorSize = false;
-    int cursorSize = cursorSizeFromEnv.toInt(&hasCursorSize);
-    if (!hasCursorSize || cursorSize <= 0)
-        cursorSize = 32;
-    mCursorTheme = wl_cursor_theme_load(cursorTheme, cursorSize, mDisplay->shm());
-    if (!mCursorTheme)
-        qDebug() << "Could not load theme" << cursorTheme;
+    mCursorSize = cursorSizeFromEnv.toInt(&hasCursorSize);
+    if (!hasCursorSize || mCursorSize <= 0)
+        mCursorSize = 32;
+    cursorTheme(1);
     initCursorMap();
 }
 
 QWaylandCursor::~QWaylandCursor()
 {
-    if (mCursorTheme)
-        wl_cursor_theme_destroy(mCursorTheme);
+    foreach (wl_cursor_theme *theme, mCursorThemes) {
+        if (theme)
+            wl_cursor_theme_destroy(theme);
+    }
+    foreach (const CursorBuffer &cursorBuffer, mCursorBuffers)
+        delete cursorBuffer.buffer;
+}
+
+struct wl_cursor_theme *QWaylandCursor::cursorTheme(int scale)
+{
+    QHash<int, wl_cursor_theme *>::const_iterator it = mCursorThemes.constFind(scale);
+    if (it != mCursorThemes.constEnd())
+        return it.value();
+
+    // Themes are loaded once per scale, also remembering failures so they are not retried
+    struct wl_cursor_theme *theme = wl_cursor_theme_load(mCursorThemeName, mCursorSize * scale, mDisplay->shm());
+    if (!theme)
+        qDebug() << "Could not load theme" << mCursorThemeName << "for scale" << scale;
+    mCursorThemes.insert(scale, theme);
+    return theme;
+}
+
+struct wl_cursor *QWaylandCursor::cursor(Qt::CursorShape shape, int scale)
+{
+    if (shape == Qt::BlankCursor || shape >= Qt::BitmapCursor)
+        return NULL;
+    return requestCursor((WaylandCursor)shape, qMax(scale, 1));
 }
 
 struct wl_cursor_image *QWaylandCursor::cursorImage(Qt::CursorShape newShape)
@@ -83,9 +111,9 @@ struct wl_cursor_image *QWaylandCursor::cursorImage(Qt::CursorShape newShape)
     }
 
     if (newShape < Qt::BitmapCursor) {
-        waylandCursor = requestCursor((WaylandCursor)newShape);
+        waylandCursor = requestCursor((WaylandCursor)newShape, 1);
     } else if (newShape == Qt::BitmapCursor) {
-        //TODO: Bitmap cursor logic
+        // Bitmap cursors have no theme image, see cursorBuffer()
     } else {
         //TODO: Custom cursor logic (for resize arrows)
     }
@@ -105,19 +133,83 @@ struct wl_cursor_image *QWaylandCursor::cursorImage(Qt::CursorShape newShape)
     return image;
 }
 
-void QWaylandCursor::changeCursor(QCursor *cursor, QWindow *window)
+QWaylandShmBuffer *QWaylandCursor::cursorBuffer(const QCursor &cursor)
 {
-    Q_UNUSED(window)
+    const QPixmap pixmap = cursor.pixmap();
+    const QBitmap *bitmap = cursor.bitmap();
+    const QBitmap *mask = cursor.mask();
+    qint64 key;
+    qint64 maskKey = 0;
+    if (!pixmap.isNull()) {
+        key = pixmap.cacheKey();
+    } else if (bitmap && mask) {
+        key = bitmap->cacheKey();
+        maskKey = mask->cacheKey();
+    } else {
+        return 0;
+    }
+
+    for (int i = 0; i < mCursorBuffers.size(); ++i) {
+        if (mCursorBuffers.at(i).key == key && mCursorBuffers.at(i).maskKey == maskKey) {
+            if (i > 0)
+                mCursorBuffers.move(i, 0);
+            return mCursorBuffers.first().buffer;
+        }
+    }
 
-    const Qt::CursorShape newShape = cursor ? cursor->shape() : Qt::ArrowCursor;
+    QImage image;
+    if (!pixmap.isNull()) {
+        image = pixmap.toImage().convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    } else {
+        // Set mask bits are opaque, set bitmap bits are black
+        const QImage bits = bitmap->toImage();
+        const QImage maskBits = mask->toImage();
+        image = QImage(bits.size(), QImage::Format_ARGB32_Premultiplied);
+        for (int y = 0; y < image.height(); ++y) {
+            QRgb *line = reinterpret_cast<QRgb *>(image.scanLine(y));
+            for (int x = 0; x < image.width(); ++x) {
+                if (qGray(maskBits.pixel(x, y)) >= 128)
+                    line[x] = 0;
+                else
+                    line[x] = qGray(bits.pixel(x, y)) < 128 ? 0xff000000 : 0xffffffff;
+            }
+        }
+    }
+    if (image.isNull())
+        return 0;
+
+    QWaylandShmBuffer *buffer = new QWaylandShmBuffer(mDisplay, image.size(), QImage::Format_ARGB32_Premultiplied);
+    QImage *target = buffer->image();
+    const int bytesPerLine = qMin(image.bytesPerLine(), target->bytesPerLine());
+    for (int y = 0; y < image.height(); ++y)
+        memcpy(target->scanLine(y), image.constScanLine(y), bytesPerLine);
+
+    CursorBuffer cursorBuffer = { key, maskKey, buffer };
+    mCursorBuffers.prepend(cursorBuffer);
+
+    // Evict the least recently used buffers, but never one that is still
+    // attached as a pointer cursor. The cache grows past its limit instead.
+    for (int i = mCursorBuffers.size() - 1; i > 0 && mCursorBuffers.size() > MaxCursorBuffers; --i) {
+        if (!isCursorBufferAttached(mCursorBuffers.at(i).buffer))
+            delete mCursorBuffers.takeAt(i).buffer;
+    }
+    return buffer;
+}
 
-    struct wl_cursor_image *image = cursorImage(newShape);
-    if (!image) {
-        return;
+bool QWaylandCursor::isCursorBufferAttached(QWaylandShmBuffer *buffer) const
+{
+    foreach (QWaylandInputDevice *inputDevice, mDisplay->inputDevices()) {
+        if (inputDevice->attachedCursorBuffer() == buffer->buffer())
+            return true;
     }
+    return false;
+}
 
-    struct wl_buffer *buffer = wl_cursor_image_get_buffer(image);
-    mDisplay->setCursor(buffer, image);
+void QWaylandCursor::changeCursor(QCursor *cursor, QWindow *window)
+{
+    Q_UNUSED(window)
+
+    mDisplay->setCursor(cursor ? *cursor : QCursor(Qt::ArrowCursor), mScreen);
 }
 
 void QWaylandDisplay::setCursor(struct wl_buffer *buffer, struct wl_cursor_image *image)
@@ -130,6 +222,12 @@ void QWaylandDisplay::setCursor(struct wl_buffer *buffer, struct wl_cursor_image
     }
 }
 
+void QWaylandDisplay::setCursor(const QCursor &cursor, QWaylandScreen *screen)
+{
+    for (int i = 0; i < mInputDevices.count(); i++)
+        mInputDevices.at(i)->setCursor(cursor, screen);
+}
+
 QWaylandInputDevice *QWaylandDisplay::defaultInputDevice() const
 {
     return mInputDevices.isEmpty() ? 0 : mInputDevices.first();
@@ -151,20 +249,22 @@ void QWaylandCursor::setPos(const QPoint &pos)
     qWarning() << "QWaylandCursor::setPos: not implemented";
 }
 
-wl_cursor *QWaylandCursor::requestCursor(WaylandCursor shape)
+wl_cursor *QWaylandCursor::requestCursor(WaylandCursor shape, int scale)
 {
-    struct wl_cursor *cursor = mCursors.value(shape, 0);
+    QMap<WaylandCursor, wl_cursor *> &cursors = mCursors[scale];
+    struct wl_cursor *cursor = cursors.value(shape, 0);
 
     //If the cursor has not been loaded already, load it
     if (!cursor) {
-        if (!mCursorTheme)
+        struct wl_cursor_theme *theme = cursorTheme(scale);
+        if (!theme)
             return NULL;
 
         QList<QByteArray> cursorNames = mCursorNamesMap.values(shape);
         foreach (const QByteArray &name, cursorNames) {
-            cursor = wl_cursor_theme_get_cursor(mCursorTheme, name.constData());
+            cursor = wl_cursor_theme_get_cursor(theme, name.constData());
             if (cursor) {
-                mCursors.insert(shape, cursor);
+                cursors.insert(shape, cursor);
                 break;
             }
         }
@@ -172,7 +272,7 @@ wl_cursor *QWaylandCursor::requestCursor(WaylandCursor shape)
 
     //If there still no cursor for a shape, use the default cursor
     if (!cursor && shape != ArrowCursor) {
-        cursor = requestCursor(ArrowCursor);
+        cursor = requestCursor(ArrowCursor, scale);
     }
 
     return cursor;
@@ -36,6 +36,8 @@
 
 #include <qpa/qplatformcursor.h>
 #include <QtCore/QMap>
+#include <QtCore/QHash>
+#include <QtCore/QList>
 #include <QtWaylandClient/private/qwaylandclientexport_p.h>
 
 struct wl_cursor;
@@ -48,6 +50,7 @@ namespace QtWaylandClient {
 
 class QWaylandDisplay;
 class QWaylandScreen;
+class QWaylandShmBuffer;
 
 class Q_WAYLAND_CLIENT_EXPORT QWaylandCursor : public QPlatformCursor
 {
@@ -61,6 +64,8 @@ public:
     void setPos(const QPoint &pos);
 
     struct wl_cursor_image *cursorImage(Qt::CursorShape shape);
+    struct wl_cursor *cursor(Qt::CursorShape shape, int scale = 1);
+    QWaylandShmBuffer *cursorBuffer(const QCursor &cursor);
 
 private:
     enum WaylandCursor {
@@ -96,13 +101,26 @@ private:
         ResizeSouthWestCursor
     };
 
-    struct wl_cursor* requestCursor(WaylandCursor shape);
+    struct CursorBuffer {
+        qint64 key;
+        qint64 maskKey;
+        QWaylandShmBuffer *buffer;
+    };
+
+    bool isCursorBufferAttached(QWaylandShmBuffer *buffer) const;
+
+    struct wl_cursor_theme *cursorTheme(int scale);
+    struct wl_cursor* requestCursor(WaylandCursor shape, int scale);
     void initCursorMap();
     QWaylandDisplay *mDisplay;
-    struct wl_cursor_theme *mCursorTheme;
+    QWaylandScreen *mScreen;
+    QByteArray mCursorThemeName;
+    int mCursorSize;
+    QHash<int, wl_cursor_theme *> mCursorThemes;
     QPoint mLastPos;
-    QMap<WaylandCursor, wl_cursor *> mCursors;
+    QHash<int, QMap<WaylandCursor, wl_cursor *> > mCursors;
     QMultiMap<WaylandCursor, QByteArray> mCursorNamesMap;
+    QList<CursorBuffer> mCursorBuffers;
 };
 
 }
@@ -134,6 +134,7 @@ QWaylandDisplay::QWaylandDisplay(QWaylandIntegration *waylandIntegration)
     , mLastKeyboardFocusInputDevice(0)
     , mDndSelectionHandler(0)
     , mWindowExtension(0)
+    , mWindowExtensionVersion(0)
     , mSubCompositor(0)
     , mTouchExtension(0)
     , mQtKeyExtension(0)
@@ -202,6 +203,17 @@ void QWaylandDisplay::blockingReadEvents()
         mEventThreadObject->checkError();
         exitWithError();
     }
+    mEventThreadObject->dispatchFrameQueues();
+}
+
+void QWaylandDisplay::addFrameQueue(struct ::wl_event_queue *queue)
+{
+    mEventThreadObject->addFrameQueue(queue);
+}
+
+void QWaylandDisplay::removeFrameQueue(struct ::wl_event_queue *queue)
+{
+    mEventThreadObject->removeFrameQueue(queue);
 }
 
 void QWaylandDisplay::exitWithError()
@@ -267,11 +279,12 @@ void QWaylandDisplay::registry_global(uint32_t id, const QString &interface, uin
     } else if (interface == QStringLiteral("wl_data_device_manager")) {
         mDndSelectionHandler.reset(new QWaylandDataDeviceManager(this, id));
     } else if (interface == QStringLiteral("qt_surface_extension")) {
-        mWindowExtension.reset(new QtWayland::qt_surface_extension(registry, id, 1));
+        mWindowExtensionVersion = qMin((int)version, 2);
+        mWindowExtension.reset(new QtWayland::qt_surface_extension(registry, id, mWindowExtensionVersion));
     } else if (interface == QStringLiteral("wl_subcompositor")) {
         mSubCompositor.reset(new QtWayland::wl_subcompositor(registry, id, 1));
     } else if (interface == QStringLiteral("qt_touch_extension")) {
-        mTouchExtension.reset(new QWaylandTouchExtension(this, id));
+        mTouchExtension.reset(new QWaylandTouchExtension(this, id, version));
     } else if (interface == QStringLiteral("qt_key_extension")) {
         mQtKeyExtension.reset(new QWaylandQtKeyExtension(this, id));
     } else if (interface == QStringLiteral("wl_text_input_manager")) {
@@ -359,6 +372,7 @@ void QWaylandDisplay::forceRoundTrip()
     } else {
         while (!done && ret >= 0)
             ret = wl_display_dispatch_queue(mDisplay, mEventQueue);
+        mEventThreadObject->dispatchFrameQueues();
     }
 
     if (ret == -1 && !done)
@@ -51,6 +51,7 @@ struct wl_cursor_image;
 QT_BEGIN_NAMESPACE
 
 class QAbstractEventDispatcher;
+class QCursor;
 class QSocketNotifier;
 class QPlatformScreen;
 
@@ -107,6 +108,7 @@ public:
     QWaylandWindowManagerIntegration *windowManagerIntegration() const;
 
     void setCursor(struct wl_buffer *buffer, struct wl_cursor_image *image);
+    void setCursor(const QCursor &cursor, QWaylandScreen *screen);
 
     struct wl_display *wl_display() const { return mDisplay; }
     struct wl_event_queue *wl_event_queue() const { return mEventQueue; }
@@ -129,6 +131,7 @@ public:
     QWaylandDataDeviceManager *dndSelectionHandler() const { return mDndSelectionHandler.data(); }
 
     QtWayland::qt_surface_extension *windowExtension() const { return mWindowExtension.data(); }
+    int windowExtensionVersion() const { return mWindowExtensionVersion; }
     QWaylandTouchExtension *touchExtension() const { return mTouchExtension.data(); }
     QtWayland::wl_text_input_manager *textInputManager() const { return mTextInputManager.data(); }
     QWaylandHardwareIntegration *hardwareIntegration() const { return mHardwareIntegration.data(); }
@@ -153,6 +156,9 @@ public:
 
     void forceRoundTrip();
 
+    void addFrameQueue(struct ::wl_event_queue *queue);
+    void removeFrameQueue(struct ::wl_event_queue *queue);
+
     bool supportsWindowDecoration() const;
 
     uint32_t lastInputSerial() const { return mLastInputSerial; }
@@ -199,6 +205,7 @@ private:
     int mWritableNotificationFd;
     QList<RegistryGlobal> mGlobals;
     int mCompositorVersion;
+    int mWindowExtensionVersion;
     uint32_t mLastInputSerial;
     QWaylandInputDevice *mLastInputDevice;
     QPointer<QWaylandWindow> mLastInputWindow;
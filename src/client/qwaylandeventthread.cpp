@@ -78,18 +78,61 @@ void QWaylandEventThread::checkError() const
     }
 }
 
+// Render threads read the display too, e.g. EGL waiting for a buffer release
+// on its own queue. All readers therefore follow the prepare_read/read_events
+// protocol: whichever thread reads last reads for everybody, and the events
+// end up in the queue of the thread that owns the object. The data the
+// notifier saw may be gone by now, in which case nothing is read, instead of
+// blocking this thread until the next event arrives.
 void QWaylandEventThread::readWaylandEvents()
 {
-    if (wl_display_dispatch(m_display) < 0) {
-        checkError();
-        m_readNotifier->setEnabled(false);
-        emit fatalError();
+    while (wl_display_prepare_read(m_display) != 0) {
+        if (wl_display_dispatch_pending(m_display) < 0) {
+            readError();
+            return;
+        }
+    }
+
+    if (wl_display_read_events(m_display) < 0 || wl_display_dispatch_pending(m_display) < 0) {
+        readError();
         return;
     }
 
+    dispatchFrameQueues();
+
     emit newEventsRead();
 }
 
+void QWaylandEventThread::readError()
+{
+    checkError();
+    m_readNotifier->setEnabled(false);
+    emit fatalError();
+}
+
+// Frame callbacks are delivered on queues of their own, which are dispatched
+// right here so that they do not depend on a responsive GUI thread.
+void QWaylandEventThread::addFrameQueue(struct wl_event_queue *queue)
+{
+    QMutexLocker lock(&m_frameQueuesLock);
+    m_frameQueues.append(queue);
+}
+
+void QWaylandEventThread::removeFrameQueue(struct wl_event_queue *queue)
+{
+    QMutexLocker lock(&m_frameQueuesLock);
+    m_frameQueues.removeOne(queue);
+}
+
+// Events can also be read by other threads blocking on their own queue, so
+// this is called after those reads as well.
+void QWaylandEventThread::dispatchFrameQueues()
+{
+    QMutexLocker lock(&m_frameQueuesLock);
+    foreach (struct wl_event_queue *queue, m_frameQueues)
+        wl_display_dispatch_queue_pending(m_display, queue);
+}
+
 void QWaylandEventThread::waylandDisplayConnect()
 {
     m_display = wl_display_connect(NULL);
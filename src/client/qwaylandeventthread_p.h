@@ -36,6 +36,7 @@
 
 #include <QObject>
 #include <QMutex>
+#include <QList>
 #include <wayland-client.h>
 
 #include <QtWaylandClient/private/qwaylandclientexport_p.h>
@@ -59,6 +60,10 @@ public:
 
     void checkError() const;
 
+    void addFrameQueue(struct wl_event_queue *queue);
+    void removeFrameQueue(struct wl_event_queue *queue);
+    void dispatchFrameQueues();
+
 private slots:
     void readWaylandEvents();
 
@@ -69,6 +74,7 @@ signals:
     void fatalError();
 
 private:
+    void readError();
 
     struct wl_display *m_display;
     int m_fileDescriptor;
@@ -77,6 +83,8 @@ private:
 
     QMutex *m_displayLock;
 
+    QMutex m_frameQueuesLock;
+    QList<struct wl_event_queue *> m_frameQueues;
 };
 
 }
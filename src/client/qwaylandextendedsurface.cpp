@@ -38,6 +38,7 @@
 #include "qwaylanddisplay_p.h"
 
 #include "qwaylandnativeinterface_p.h"
+#include "../shared/qwaylandpropertycodec.h"
 
 #include <QtGui/QGuiApplication>
 #include <qpa/qplatformnativeinterface.h>
@@ -50,21 +51,64 @@ namespace QtWaylandClient {
 QWaylandExtendedSurface::QWaylandExtendedSurface(QWaylandWindow *window)
     : QtWayland::qt_extended_surface(window->display()->windowExtension()->get_extended_surface(window->object()))
     , m_window(window)
+    , m_binaryProperties(window->display()->windowExtensionVersion() >= 2)
 {
 }
 
 QWaylandExtendedSurface::~QWaylandExtendedSurface()
 {
+    flushProperties();
     qt_extended_surface_destroy(object());
 }
 
 void QWaylandExtendedSurface::updateGenericProperty(const QString &name, const QVariant &value)
 {
-    QByteArray byteValue;
-    QDataStream ds(&byteValue, QIODevice::WriteOnly);
-    ds << value;
+    QVariantMap::iterator it = m_properties.find(name);
+    if (it != m_properties.end() && it.value() == value)
+        return;
+    if (it != m_properties.end())
+        it.value() = value;
+    else
+        m_properties.insert(name, value);
+
+    if (!m_binaryProperties) {
+        QByteArray byteValue;
+        QDataStream ds(&byteValue, QIODevice::WriteOnly);
+        ds << value;
+
+        update_generic_property(name, byteValue);
+        return;
+    }
+
+    uint id = m_propertyIds.value(name);
+    if (!id) {
+        id = m_propertyIds.size() + 1;
+        m_propertyIds.insert(name, id);
+        intern_property(id, name);
+    }
+
+    // Changes made while handling one event are sent together, and only the
+    // last value of a property is sent. They go out with the next commit of
+    // the surface at the latest.
+    QMutexLocker lock(&m_pendingPropertiesLock);
+    if (m_pendingProperties.isEmpty())
+        QMetaObject::invokeMethod(this, "flushProperties", Qt::QueuedConnection);
+    m_pendingProperties.insert(id, value);
+}
+
+void QWaylandExtendedSurface::flushProperties()
+{
+    QMutexLocker lock(&m_pendingPropertiesLock);
+    if (m_pendingProperties.isEmpty())
+        return;
 
-    update_generic_property(name, byteValue);
+    QByteArray data;
+    for (QHash<uint, QVariant>::const_iterator it = m_pendingProperties.constBegin();
+         it != m_pendingProperties.constEnd(); ++it)
+        QWaylandPropertyCodec::encode(data, it.key(), it.value());
+    m_pendingProperties.clear();
+
+    update_properties(data);
 }
 
 void QWaylandExtendedSurface::setContentOrientationMask(Qt::ScreenOrientations mask)
@@ -96,9 +140,33 @@ void QWaylandExtendedSurface::extended_surface_set_generic_property(const QStrin
     QDataStream ds(data);
     ds >> variantValue;
 
+    m_properties.insert(name, variantValue);
     m_window->setProperty(name, variantValue);
 }
 
+void QWaylandExtendedSurface::extended_surface_intern_property(uint32_t id, const QString &name)
+{
+    m_compositorPropertyNames.insert(id, name);
+}
+
+void QWaylandExtendedSurface::extended_surface_set_properties(wl_array *data)
+{
+    const QByteArray records = QByteArray::fromRawData(static_cast<char *>(data->data), data->size);
+    int offset = 0;
+    while (offset < records.size()) {
+        uint id;
+        QVariant value;
+        if (!QWaylandPropertyCodec::decode(records, offset, id, value))
+            return;
+
+        const QString name = m_compositorPropertyNames.value(id);
+        if (name.isEmpty())
+            continue;
+        m_properties.insert(name, value);
+        m_window->setProperty(name, value);
+    }
+}
+
 void QWaylandExtendedSurface::extended_surface_close()
 {
     QWindowSystemInterface::handleCloseEvent(m_window->window());
@@ -34,6 +34,9 @@
 #ifndef QWAYLANDEXTENDEDSURFACE_H
 #define QWAYLANDEXTENDEDSURFACE_H
 
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QObject>
 #include <QtCore/QString>
 #include <QtCore/QVariant>
 
@@ -49,8 +52,9 @@ namespace QtWaylandClient {
 class QWaylandDisplay;
 class QWaylandWindow;
 
-class Q_WAYLAND_CLIENT_EXPORT QWaylandExtendedSurface : public QtWayland::qt_extended_surface
+class Q_WAYLAND_CLIENT_EXPORT QWaylandExtendedSurface : public QObject, public QtWayland::qt_extended_surface
 {
+    Q_OBJECT
 public:
     QWaylandExtendedSurface(QWaylandWindow *window);
     ~QWaylandExtendedSurface();
@@ -61,13 +65,26 @@ public:
 
     Qt::WindowFlags setWindowFlags(Qt::WindowFlags flags);
 
+public slots:
+    void flushProperties();
+
 private:
     void extended_surface_onscreen_visibility(int32_t visibility) Q_DECL_OVERRIDE;
     void extended_surface_set_generic_property(const QString &name, wl_array *value) Q_DECL_OVERRIDE;
     void extended_surface_close() Q_DECL_OVERRIDE;
+    void extended_surface_intern_property(uint32_t id, const QString &name) Q_DECL_OVERRIDE;
+    void extended_surface_set_properties(wl_array *data) Q_DECL_OVERRIDE;
 
     QWaylandWindow *m_window;
+    // Last value of each property known to the compositor, sent or pending
     QVariantMap m_properties;
+
+    bool m_binaryProperties;
+    QHash<QString, uint> m_propertyIds;
+    QHash<uint, QString> m_compositorPropertyNames;
+    // Flushed with the next commit, which may happen on a render thread
+    QMutex m_pendingPropertiesLock;
+    QHash<uint, QVariant> m_pendingProperties;
 };
 
 }
@@ -89,11 +89,35 @@ static QEvent::Type toQEventType(uint32_t state)
     }
 }
 
+// Number of characters sent as surrounding text before and after the cursor
+static const int surroundingTextContext = 512;
+
+static int utf8Length(const QChar *text, int length)
+{
+    int bytes = 0;
+    for (int i = 0; i < length; ++i) {
+        const ushort c = text[i].unicode();
+        if (c < 0x80) {
+            bytes += 1;
+        } else if (c < 0x800) {
+            bytes += 2;
+        } else if (QChar::isHighSurrogate(c) && i + 1 < length && QChar::isLowSurrogate(text[i + 1].unicode())) {
+            bytes += 4;
+            ++i;
+        } else {
+            bytes += 3;
+        }
+    }
+    return bytes;
+}
+
 QWaylandTextInput::QWaylandTextInput(struct ::wl_text_input *text_input)
     : QtWayland::wl_text_input(text_input)
     , m_commit()
     , m_serial(0)
     , m_resetSerial(0)
+    , m_surroundingCursor(-1)
+    , m_surroundingAnchor(-1)
 {
 }
 
@@ -105,10 +129,22 @@ QString QWaylandTextInput::commitString() const
 void QWaylandTextInput::reset()
 {
     wl_text_input::reset();
+    invalidateState();
     updateState();
     m_resetSerial = m_serial;
 }
 
+/*
+    Forgets the state last sent to the compositor, so that the next
+    updateState() sends it again even if it did not change.
+*/
+void QWaylandTextInput::invalidateState()
+{
+    m_surroundingText = QString();
+    m_surroundingCursor = -1;
+    m_surroundingAnchor = -1;
+}
+
 void QWaylandTextInput::updateState()
 {
     if (!QGuiApplication::focusObject())
@@ -118,10 +154,33 @@ void QWaylandTextInput::updateState()
     QCoreApplication::sendEvent(QGuiApplication::focusObject(), &event);
 
     const QString &text = event.value(Qt::ImSurroundingText).toString();
-    const int cursor = event.value(Qt::ImCursorPosition).toInt();
-    const int anchor = event.value(Qt::ImAnchorPosition).toInt();
+    const int cursor = qBound(0, event.value(Qt::ImCursorPosition).toInt(), text.length());
+    int anchor = qBound(0, event.value(Qt::ImAnchorPosition).toInt(), text.length());
+
+    // Only a window of the text around the cursor is sent, so that moving the
+    // cursor in a large document does not transfer the whole document. The
+    // selection is clipped to the window.
+    int start = qMax(0, cursor - surroundingTextContext);
+    int end = qMin(text.length(), cursor + surroundingTextContext);
+    if (start > 0 && text.at(start).isLowSurrogate())
+        --start;
+    if (end < text.length() && text.at(end - 1).isHighSurrogate())
+        ++end;
+    anchor = qBound(start, anchor, end);
+
+    const QStringRef window = text.midRef(start, end - start);
+    if (window == m_surroundingText && cursor - start == m_surroundingCursor
+            && anchor - start == m_surroundingAnchor)
+        return;
+
+    m_surroundingText = window.toString();
+    m_surroundingCursor = cursor - start;
+    m_surroundingAnchor = anchor - start;
 
-    set_surrounding_text(text, text.leftRef(cursor).toUtf8().size(), text.leftRef(anchor).toUtf8().size());
+    const QChar *data = m_surroundingText.constData();
+    set_surrounding_text(m_surroundingText,
+                         utf8Length(data, m_surroundingCursor),
+                         utf8Length(data, m_surroundingAnchor));
 
     commit_state(++m_serial);
 }
@@ -153,6 +212,7 @@ void QWaylandTextInput::text_input_commit_string(uint32_t serial, const QString
 
 void QWaylandTextInput::text_input_enter(wl_surface *)
 {
+    invalidateState();
     updateState();
     m_resetSerial = m_serial;
 }
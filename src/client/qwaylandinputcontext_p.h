@@ -60,6 +60,7 @@ public:
 
     void reset();
     void updateState();
+    void invalidateState();
 
 protected:
     void text_input_preedit_string(uint32_t serial, const QString &text, const QString &commit) Q_DECL_OVERRIDE;
@@ -73,6 +74,10 @@ private:
 
     uint32_t m_serial;
     uint32_t m_resetSerial;
+
+    QString m_surroundingText;
+    int m_surroundingCursor;
+    int m_surroundingAnchor;
 };
 
 class QWaylandInputContext : public QPlatformInputContext
@@ -42,6 +42,7 @@
 #include "qwaylandscreen_p.h"
 #include "qwaylandcursor_p.h"
 #include "qwaylanddisplay_p.h"
+#include "qwaylandshmbackingstore_p.h"
 #include "../shared/qwaylandxkb.h"
 
 #include <QtGui/private/qpixmap_raster_p.h>
@@ -67,14 +68,78 @@ QWaylandInputDevice::Keyboard::Keyboard(QWaylandInputDevice *p)
     , mXkbContext(0)
     , mXkbMap(0)
     , mXkbState(0)
+    , mCapsLockIndex(XKB_MOD_INVALID)
 #endif
     , mFocusCallback(0)
     , mNativeModifiers(0)
+    , mModifiers(Qt::NoModifier)
+    , mRepeatDue(0)
 {
     connect(&mRepeatTimer, SIGNAL(timeout()), this, SLOT(repeatKey()));
 }
 
 #ifndef QT_NO_WAYLAND_XKB
+static inline quint32 keyTableIndex(xkb_keycode_t code, xkb_layout_index_t layout,
+                                    xkb_level_index_t level, bool capsLock)
+{
+    return (code << 16) | ((layout & 0xff) << 8) | ((level & 0x7f) << 1) | (capsLock ? 1 : 0);
+}
+
+static QWaylandInputDevice::Keyboard::KeyInfo makeKeyInfo(xkb_keysym_t sym)
+{
+    QWaylandInputDevice::Keyboard::KeyInfo info;
+    info.sym = sym;
+
+    uint utf32 = xkb_keysym_to_utf32(sym);
+    if (utf32)
+        info.text = QString::fromUcs4(&utf32, 1);
+
+    Qt::KeyboardModifiers modifiers = Qt::NoModifier;
+    info.key = QWaylandXkb::keysymToQtKey(sym, modifiers, info.text);
+    info.keypad = modifiers & Qt::KeypadModifier;
+
+    return info;
+}
+
+/*
+    Resolves every keycode/layout/level combination of the current keymap
+    once, so that key events only have to look up the keysym, Qt key and text.
+    Combinations affected by Caps Lock are resolved lazily in lookupKey().
+*/
+void QWaylandInputDevice::Keyboard::buildKeyTable()
+{
+    mKeyTable.clear();
+    mCapsLockIndex = xkb_keymap_mod_get_index(mXkbMap, XKB_MOD_NAME_CAPS);
+
+    const xkb_keycode_t minCode = xkb_keymap_min_keycode(mXkbMap);
+    const xkb_keycode_t maxCode = xkb_keymap_max_keycode(mXkbMap);
+    for (xkb_keycode_t code = minCode; code <= maxCode; ++code) {
+        const xkb_layout_index_t layouts = xkb_keymap_num_layouts_for_key(mXkbMap, code);
+        for (xkb_layout_index_t layout = 0; layout < layouts; ++layout) {
+            const xkb_level_index_t levels = xkb_keymap_num_levels_for_key(mXkbMap, code, layout);
+            for (xkb_level_index_t level = 0; level < levels; ++level) {
+                const xkb_keysym_t *syms;
+                if (xkb_keymap_key_get_syms_by_level(mXkbMap, code, layout, level, &syms) == 1)
+                    mKeyTable.insert(keyTableIndex(code, layout, level, false), makeKeyInfo(syms[0]));
+            }
+        }
+    }
+}
+
+const QWaylandInputDevice::Keyboard::KeyInfo &QWaylandInputDevice::Keyboard::lookupKey(uint32_t code)
+{
+    const xkb_layout_index_t layout = xkb_state_key_get_layout(mXkbState, code);
+    const xkb_level_index_t level = xkb_state_key_get_level(mXkbState, code, layout);
+    const bool capsLock = mCapsLockIndex != XKB_MOD_INVALID
+            && xkb_state_mod_index_is_active(mXkbState, mCapsLockIndex, XKB_STATE_MODS_EFFECTIVE) > 0;
+
+    const quint32 index = keyTableIndex(code, layout, level, capsLock);
+    QHash<quint32, KeyInfo>::iterator it = mKeyTable.find(index);
+    if (it == mKeyTable.end())
+        it = mKeyTable.insert(index, makeKeyInfo(xkb_state_key_get_one_sym(mXkbState, code)));
+    return it.value();
+}
+
 bool QWaylandInputDevice::Keyboard::createDefaultKeyMap()
 {
     if (mXkbContext && mXkbMap && mXkbState) {
@@ -100,6 +165,7 @@ bool QWaylandInputDevice::Keyboard::createDefaultKeyMap()
         qWarning() << "xkb_map_new_from_names failed, no key input";
         return false;
     }
+    buildKeyTable();
     return true;
 }
 
@@ -111,6 +177,7 @@ void QWaylandInputDevice::Keyboard::releaseKeyMap()
         xkb_map_unref(mXkbMap);
     if (mXkbContext)
         xkb_context_unref(mXkbContext);
+    mKeyTable.clear();
 }
 #endif
 
@@ -172,6 +239,12 @@ QWaylandInputDevice::QWaylandInputDevice(QWaylandDisplay *display, int version,
     , mDisplay(display->wl_display())
     , mVersion(qMin(version, 3))
     , mCaps(0)
+    , pointerSurface(0)
+    , mCursorBuffer(0)
+    , mCursorBufferScale(1)
+    , mThemeCursor(0)
+    , mThemeCursorScale(1)
+    , mCursorFrame(0)
     , mDataDevice(0)
     , mKeyboard(0)
     , mPointer(0)
@@ -184,6 +257,8 @@ QWaylandInputDevice::QWaylandInputDevice(QWaylandDisplay *display, int version,
         mDataDevice = mQDisplay->dndSelectionHandler()->getDataDevice(this);
     }
 
+    mCursorTimer.setSingleShot(true);
+    connect(&mCursorTimer, SIGNAL(timeout()), this, SLOT(updateCursorFrame()));
 }
 
 QWaylandInputDevice::~QWaylandInputDevice()
@@ -209,6 +284,8 @@ void QWaylandInputDevice::seat_capabilities(uint32_t caps)
         mPointer = createPointer(this);
         mPointer->init(get_pointer());
         pointerSurface = mQDisplay->createSurface(this);
+        mCursorBuffer = 0;
+        mCursorBufferScale = 1;
     } else if (!(caps & WL_SEAT_CAPABILITY_POINTER) && mPointer) {
         delete mPointer;
         mPointer = 0;
@@ -297,16 +374,7 @@ Qt::KeyboardModifiers QWaylandInputDevice::modifiers() const
 
 Qt::KeyboardModifiers QWaylandInputDevice::Keyboard::modifiers() const
 {
-    Qt::KeyboardModifiers ret = Qt::NoModifier;
-
-#ifndef QT_NO_WAYLAND_XKB
-    if (!mXkbState)
-        return ret;
-
-    ret = QWaylandXkb::modifiers(mXkbState);
-#endif
-
-    return ret;
+    return mModifiers;
 }
 
 uint32_t QWaylandInputDevice::cursorSerial() const
@@ -318,32 +386,117 @@ uint32_t QWaylandInputDevice::cursorSerial() const
 
 void QWaylandInputDevice::setCursor(Qt::CursorShape newShape, QWaylandScreen *screen)
 {
-    struct wl_cursor_image *image = screen->waylandCursor()->cursorImage(newShape);
-    if (!image) {
+    if (newShape == Qt::BlankCursor) {
+        mThemeCursor = 0;
+        mCursorTimer.stop();
+        applyCursor(0, QPoint(), QSize(), 1);
         return;
     }
 
-    struct wl_buffer *buffer = wl_cursor_image_get_buffer(image);
-    setCursor(buffer, image);
+    const int scale = screen->scale();
+    struct wl_cursor *cursor = screen->waylandCursor()->cursor(newShape, scale);
+    if (!cursor) {
+        qDebug("Could not find cursor for shape %d", newShape);
+        return;
+    }
+
+    // Setting the same shape again must not restart its animation
+    if (cursor != mThemeCursor || scale != mThemeCursorScale) {
+        mThemeCursor = cursor;
+        mThemeCursorScale = scale;
+        mCursorFrame = 0;
+        mCursorTimer.stop();
+    }
+    showCursorFrame();
+}
+
+void QWaylandInputDevice::setCursor(const QCursor &cursor, QWaylandScreen *screen)
+{
+    if (cursor.shape() != Qt::BitmapCursor) {
+        setCursor(cursor.shape(), screen);
+        return;
+    }
+
+    QWaylandShmBuffer *buffer = screen->waylandCursor()->cursorBuffer(cursor);
+    if (!buffer)
+        return;
+
+    mThemeCursor = 0;
+    mCursorTimer.stop();
+    applyCursor(buffer->buffer(), cursor.hotSpot(), buffer->size(), 1);
 }
 
 void QWaylandInputDevice::setCursor(struct wl_buffer *buffer, struct wl_cursor_image *image)
 {
-    if (mCaps & WL_SEAT_CAPABILITY_POINTER) {
-        mPointer->mCursorSerial = mPointer->mEnterSerial;
-        /* Hide cursor */
-        if (!buffer)
-        {
-            mPointer->set_cursor(mPointer->mEnterSerial, NULL, 0, 0);
-            return;
-        }
+    mThemeCursor = 0;
+    mCursorTimer.stop();
+    if (!buffer || !image)
+        applyCursor(0, QPoint(), QSize(), 1);
+    else
+        applyCursor(buffer, QPoint(image->hotspot_x, image->hotspot_y), QSize(image->width, image->height), 1);
+}
+
+void QWaylandInputDevice::showCursorFrame()
+{
+    struct wl_cursor_image *image = mThemeCursor->images[mCursorFrame];
+    struct wl_buffer *buffer = wl_cursor_image_get_buffer(image);
+    if (!buffer) {
+        qDebug("Could not find buffer for cursor");
+        return;
+    }
+
+    applyCursor(buffer, QPoint(image->hotspot_x, image->hotspot_y) / mThemeCursorScale,
+                QSize(image->width, image->height), mThemeCursorScale);
+
+    if (mThemeCursor->image_count > 1 && image->delay > 0 && !mCursorTimer.isActive())
+        mCursorTimer.start(image->delay);
+}
+
+void QWaylandInputDevice::updateCursorFrame()
+{
+    // The animation stops while the pointer is outside our surfaces and is
+    // picked up again by the cursor update on the next enter
+    if (!mThemeCursor || !mPointer || !mPointer->mFocus)
+        return;
 
-        mPointer->set_cursor(mPointer->mEnterSerial, pointerSurface,
-                             image->hotspot_x, image->hotspot_y);
+    mCursorFrame = (mCursorFrame + 1) % mThemeCursor->image_count;
+    showCursorFrame();
+}
+
+void QWaylandInputDevice::applyCursor(struct wl_buffer *buffer, const QPoint &hotSpot, const QSize &size, int bufferScale)
+{
+    if (!(mCaps & WL_SEAT_CAPABILITY_POINTER))
+        return;
+
+    // The compositor drops the cursor on every enter, so the state can only be
+    // reused for the enter serial it was set with
+    const bool sameEnter = mPointer->mCursorSerial == mPointer->mEnterSerial;
+    if (sameEnter && buffer == mCursorBuffer
+            && (!buffer || (hotSpot == mCursorHotSpot && bufferScale == mCursorBufferScale)))
+        return;
+
+    mPointer->mCursorSerial = mPointer->mEnterSerial;
+    /* Hide cursor */
+    if (!buffer) {
+        mPointer->set_cursor(mPointer->mEnterSerial, NULL, 0, 0);
+        mCursorBuffer = 0;
+        return;
+    }
+
+    if (!sameEnter || !mCursorBuffer || hotSpot != mCursorHotSpot)
+        mPointer->set_cursor(mPointer->mEnterSerial, pointerSurface, hotSpot.x(), hotSpot.y());
+
+    if (buffer != mCursorBuffer || bufferScale != mCursorBufferScale) {
+        if (bufferScale != mCursorBufferScale && mQDisplay->compositorVersion() >= 3)
+            wl_surface_set_buffer_scale(pointerSurface, bufferScale);
         wl_surface_attach(pointerSurface, buffer, 0, 0);
-        wl_surface_damage(pointerSurface, 0, 0, image->width, image->height);
+        wl_surface_damage(pointerSurface, 0, 0, size.width(), size.height());
         wl_surface_commit(pointerSurface);
     }
+
+    mCursorBuffer = buffer;
+    mCursorHotSpot = hotSpot;
+    mCursorBufferScale = bufferScale;
 }
 
 class EnterEvent : public QWaylandPointerEvent
@@ -360,6 +513,8 @@ void QWaylandInputDevice::Pointer::pointer_enter(uint32_t serial, struct wl_surf
     if (!surface)
         return;
 
+    mParent->flushKeyEvents();
+
     QWaylandWindow *window = QWaylandWindow::fromWlSurface(surface);
     window->window()->setCursor(window->window()->cursor());
 
@@ -384,6 +539,8 @@ void QWaylandInputDevice::Pointer::pointer_leave(uint32_t time, struct wl_surfac
     if (!surface)
         return;
 
+    mParent->flushKeyEvents();
+
     if (!QWaylandWindow::mouseGrab()) {
         QWaylandWindow *window = QWaylandWindow::fromWlSurface(surface);
         window->handleMouseLeave(mParent);
@@ -405,6 +562,8 @@ public:
 
 void QWaylandInputDevice::Pointer::pointer_motion(uint32_t time, wl_fixed_t surface_x, wl_fixed_t surface_y)
 {
+    mParent->flushKeyEvents();
+
     QWaylandWindow *window = mFocus;
 
     if (window == NULL) {
@@ -439,6 +598,8 @@ void QWaylandInputDevice::Pointer::pointer_motion(uint32_t time, wl_fixed_t surf
 void QWaylandInputDevice::Pointer::pointer_button(uint32_t serial, uint32_t time,
                                                   uint32_t button, uint32_t state)
 {
+    mParent->flushKeyEvents();
+
     QWaylandWindow *window = mFocus;
     Qt::MouseButton qt_button;
 
@@ -497,6 +658,8 @@ public:
 
 void QWaylandInputDevice::Pointer::pointer_axis(uint32_t time, uint32_t axis, int32_t value)
 {
+    mParent->flushKeyEvents();
+
     QWaylandWindow *window = mFocus;
     QPoint pixelDelta;
     QPoint angleDelta;
@@ -546,6 +709,9 @@ void QWaylandInputDevice::Keyboard::keyboard_keymap(uint32_t format, int32_t fd,
     close(fd);
 
     mXkbState = xkb_state_new(mXkbMap);
+    mModifiers = Qt::NoModifier;
+    if (mXkbMap && mXkbState)
+        buildKeyTable();
 #else
     Q_UNUSED(format);
     Q_UNUSED(fd);
@@ -576,6 +742,8 @@ void QWaylandInputDevice::Keyboard::keyboard_leave(uint32_t time, struct wl_surf
     Q_UNUSED(time);
     Q_UNUSED(surface);
 
+    flushKeyEvents();
+
     if (surface) {
         QWaylandWindow *window = QWaylandWindow::fromWlSurface(surface);
         window->unfocus();
@@ -635,27 +803,20 @@ void QWaylandInputDevice::Keyboard::keyboard_key(uint32_t serial, uint32_t time,
         return;
     }
 
-    const xkb_keysym_t sym = xkb_state_key_get_one_sym(mXkbState, code);
+    const KeyInfo &info = lookupKey(code);
+    const xkb_keysym_t sym = info.sym;
 
-    Qt::KeyboardModifiers modifiers = mParent->modifiers();
-
-    uint utf32 = xkb_keysym_to_utf32(sym);
-    if (utf32)
-        text = QString::fromUcs4(&utf32, 1);
+    Qt::KeyboardModifiers modifiers = mModifiers;
+    if (info.keypad)
+        modifiers |= Qt::KeypadModifier;
 
-    qtkey = QWaylandXkb::keysymToQtKey(sym, modifiers, text);
+    text = info.text;
+    qtkey = info.key;
 
-    QWindowSystemInterface::handleExtendedKeyEvent(window->window(),
-                                                    time, type, qtkey,
-                                                    modifiers,
-                                                    code, sym, mNativeModifiers, text);
+    queueKeyEvent(window, time, type, qtkey, modifiers, code, sym, text);
 #else
     // Generic fallback for single hard keys: Assume 'key' is a Qt key code.
-    QWindowSystemInterface::handleExtendedKeyEvent(window->window(),
-                                                    time, type,
-                                                    qtkey,
-                                                    Qt::NoModifier,
-                                                    code, 0, 0);
+    queueKeyEvent(window, time, type, qtkey, Qt::NoModifier, code, 0, QString());
 #endif
 
     if (state == WL_KEYBOARD_KEY_STATE_PRESSED
@@ -672,14 +833,75 @@ void QWaylandInputDevice::Keyboard::keyboard_key(uint32_t serial, uint32_t time,
 #endif
         mRepeatTimer.setInterval(400);
         mRepeatTimer.start();
+        mRepeatClock.start();
+        mRepeatDue = 400;
     } else if (mRepeatCode == code) {
         mRepeatTimer.stop();
     }
 }
 
+void QWaylandInputDevice::Keyboard::queueKeyEvent(QWaylandWindow *window, uint32_t time, QEvent::Type type,
+                                                  int key, Qt::KeyboardModifiers modifiers, uint32_t code,
+                                                  uint32_t sym, const QString &text)
+{
+    // Key events are collected while the display queue is being dispatched and
+    // handed to QWindowSystemInterface together once the dispatch is done.
+    if (mPendingKeyEvents.isEmpty())
+        QMetaObject::invokeMethod(this, "flushKeyEvents", Qt::QueuedConnection);
+
+    PendingKeyEvent event;
+    event.window = window->window();
+    event.time = time;
+    event.type = type;
+    event.key = key;
+    event.modifiers = modifiers;
+    event.code = code;
+    event.sym = sym;
+    event.nativeModifiers = mNativeModifiers;
+    event.text = text;
+    mPendingKeyEvents.append(event);
+}
+
+void QWaylandInputDevice::Keyboard::flushKeyEvents()
+{
+    if (mPendingKeyEvents.isEmpty())
+        return;
+
+    QVector<PendingKeyEvent> events;
+    events.swap(mPendingKeyEvents);
+
+    for (int i = 0; i < events.size(); ++i) {
+        const PendingKeyEvent &event = events.at(i);
+        if (!event.window)
+            continue;
+        QWindowSystemInterface::handleExtendedKeyEvent(event.window, event.time, event.type, event.key,
+                                                       event.modifiers, event.code, event.sym,
+                                                       event.nativeModifiers, event.text);
+    }
+}
+
 void QWaylandInputDevice::Keyboard::repeatKey()
 {
     mRepeatTimer.setInterval(25);
+
+    if (!mFocus) {
+        mRepeatTimer.stop();
+        return;
+    }
+
+    flushKeyEvents();
+
+    // When the event loop was stalled for longer than the repeat interval, the
+    // repeats that were missed are compressed into a single press carrying the
+    // accumulated text and count, the way QWidget key compression does.
+    const qint64 now = mRepeatClock.elapsed();
+    int count = 1;
+    if (now > mRepeatDue)
+        count += qMin<qint64>((now - mRepeatDue) / 25, 0xffff - 1);
+    mRepeatDue += count * 25;
+
+    const QString text = count > 1 ? mRepeatText.repeated(count) : mRepeatText;
+
     QWindowSystemInterface::handleExtendedKeyEvent(mFocus->window(),
                                                    mRepeatTime, QEvent::KeyRelease, mRepeatKey,
                                                    modifiers(),
@@ -700,7 +922,7 @@ void QWaylandInputDevice::Keyboard::repeatKey()
 #else
                                                    0, 0,
 #endif
-                                                   mRepeatText, true);
+                                                   text, true, count);
 }
 
 void QWaylandInputDevice::Keyboard::keyboard_modifiers(uint32_t serial,
@@ -716,6 +938,7 @@ void QWaylandInputDevice::Keyboard::keyboard_modifiers(uint32_t serial,
                               mods_depressed, mods_latched, mods_locked,
                               0, 0, group);
     mNativeModifiers = mods_depressed | mods_latched | mods_locked;
+    mModifiers = mXkbState ? QWaylandXkb::modifiers(mXkbState) : Qt::NoModifier;
 #else
     Q_UNUSED(serial);
     Q_UNUSED(mods_depressed);
@@ -732,6 +955,7 @@ void QWaylandInputDevice::Touch::touch_down(uint32_t serial,
                                      wl_fixed_t x,
                                      wl_fixed_t y)
 {
+    mParent->flushKeyEvents();
     mParent->mTime = time;
     mParent->mSerial = serial;
     mFocus = QWaylandWindow::fromWlSurface(surface);
@@ -743,6 +967,7 @@ void QWaylandInputDevice::Touch::touch_up(uint32_t serial, uint32_t time, int32_
 {
     Q_UNUSED(serial);
     Q_UNUSED(time);
+    mParent->flushKeyEvents();
     mFocus = 0;
     mParent->handleTouchPoint(id, 0, 0, Qt::TouchPointReleased);
 
@@ -757,11 +982,13 @@ void QWaylandInputDevice::Touch::touch_up(uint32_t serial, uint32_t time, int32_
 void QWaylandInputDevice::Touch::touch_motion(uint32_t time, int32_t id, wl_fixed_t x, wl_fixed_t y)
 {
     Q_UNUSED(time);
+    mParent->flushKeyEvents();
     mParent->handleTouchPoint(id, wl_fixed_to_double(x), wl_fixed_to_double(y), Qt::TouchPointMoved);
 }
 
 void QWaylandInputDevice::Touch::touch_cancel()
 {
+    mParent->flushKeyEvents();
     mPrevTouchPoints.clear();
     mTouchPoints.clear();
 
@@ -810,6 +1037,17 @@ void QWaylandInputDevice::handleTouchPoint(int id, double x, double y, Qt::Touch
     mTouch->mTouchPoints.append(tp);
 }
 
+/*
+    Key events are delivered once the dispatch they arrived in is done, while
+    pointer and touch events are delivered right away. Every pointer and touch
+    handler flushes the pending keys first, so input keeps its order.
+*/
+void QWaylandInputDevice::flushKeyEvents()
+{
+    if (mKeyboard)
+        mKeyboard->flushKeyEvents();
+}
+
 bool QWaylandInputDevice::Touch::allTouchPointsReleased()
 {
     for (int i = 0; i < mTouchPoints.count(); ++i)
@@ -821,6 +1059,8 @@ bool QWaylandInputDevice::Touch::allTouchPointsReleased()
 
 void QWaylandInputDevice::Touch::touch_frame()
 {
+    mParent->flushKeyEvents();
+
     // Copy all points, that are in the previous but not in the current list, as stationary.
     for (int i = 0; i < mPrevTouchPoints.count(); ++i) {
         const QWindowSystemInterface::TouchPoint &prevPoint(mPrevTouchPoints.at(i));
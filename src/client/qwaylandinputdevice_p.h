@@ -39,6 +39,10 @@
 #include <QSocketNotifier>
 #include <QObject>
 #include <QTimer>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QPointer>
+#include <QVector>
 #include <qpa/qplatformintegration.h>
 #include <qpa/qplatformscreen.h>
 #include <qpa/qwindowsysteminterface.h>
@@ -54,6 +58,7 @@
 
 #include <QtCore/QDebug>
 
+struct wl_cursor;
 struct wl_cursor_image;
 
 QT_BEGIN_NAMESPACE
@@ -83,6 +88,7 @@ public:
 
     void setCursor(Qt::CursorShape cursor, QWaylandScreen *screen);
     void setCursor(struct wl_buffer *buffer, struct ::wl_cursor_image *image);
+    void setCursor(const QCursor &cursor, QWaylandScreen *screen);
     void handleWindowDestroyed(QWaylandWindow *window);
 
     void setDataDevice(QWaylandDataDevice *device);
@@ -98,11 +104,15 @@ public:
 
     uint32_t serial() const;
     uint32_t cursorSerial() const;
+    struct wl_buffer *attachedCursorBuffer() const { return mCursorBuffer; }
 
     virtual Keyboard *createKeyboard(QWaylandInputDevice *device);
     virtual Pointer *createPointer(QWaylandInputDevice *device);
     virtual Touch *createTouch(QWaylandInputDevice *device);
 
+private slots:
+    void updateCursorFrame();
+
 private:
     QWaylandDisplay *mQDisplay;
     struct wl_display *mDisplay;
@@ -112,6 +122,17 @@ private:
 
     struct wl_surface *pointerSurface;
 
+    // What is currently attached to pointerSurface, to skip redundant requests
+    struct wl_buffer *mCursorBuffer;
+    QPoint mCursorHotSpot;
+    int mCursorBufferScale;
+
+    // Theme cursor being shown, animated with mCursorTimer if it has several frames
+    struct ::wl_cursor *mThemeCursor;
+    int mThemeCursorScale;
+    uint mCursorFrame;
+    QTimer mCursorTimer;
+
     QWaylandDataDevice *mDataDevice;
 
     Keyboard *mKeyboard;
@@ -122,7 +143,10 @@ private:
     uint32_t mSerial;
 
     void seat_capabilities(uint32_t caps) Q_DECL_OVERRIDE;
+    void showCursorFrame();
+    void applyCursor(struct wl_buffer *buffer, const QPoint &hotSpot, const QSize &size, int bufferScale);
     void handleTouchPoint(int id, double x, double y, Qt::TouchPointState state);
+    void flushKeyEvents();
 
     QTouchDevice *mTouchDevice;
 
@@ -162,15 +186,37 @@ public:
                             uint32_t mods_locked,
                             uint32_t group) Q_DECL_OVERRIDE;
 
+    struct KeyInfo {
+        uint32_t sym;
+        int key;
+        bool keypad;
+        QString text;
+    };
+
+    struct PendingKeyEvent {
+        QPointer<QWindow> window;
+        uint32_t time;
+        QEvent::Type type;
+        int key;
+        Qt::KeyboardModifiers modifiers;
+        uint32_t code;
+        uint32_t sym;
+        uint32_t nativeModifiers;
+        QString text;
+    };
+
     QWaylandInputDevice *mParent;
     QWaylandWindow *mFocus;
 #ifndef QT_NO_WAYLAND_XKB
     xkb_context *mXkbContext;
     xkb_keymap *mXkbMap;
     xkb_state *mXkbState;
+    xkb_mod_index_t mCapsLockIndex;
+    QHash<quint32, KeyInfo> mKeyTable;
 #endif
     struct wl_callback *mFocusCallback;
     uint32_t mNativeModifiers;
+    Qt::KeyboardModifiers mModifiers;
 
     int mRepeatKey;
     uint32_t mRepeatCode;
@@ -180,12 +226,19 @@ public:
     xkb_keysym_t mRepeatSym;
 #endif
     QTimer mRepeatTimer;
+    QElapsedTimer mRepeatClock;
+    qint64 mRepeatDue;
+
+    QVector<PendingKeyEvent> mPendingKeyEvents;
 
     static const wl_callback_listener callback;
     static void focusCallback(void *data, struct wl_callback *callback, uint32_t time);
 
     Qt::KeyboardModifiers modifiers() const;
 
+public slots:
+    void flushKeyEvents();
+
 private slots:
     void repeatKey();
 
@@ -193,7 +246,12 @@ private:
 #ifndef QT_NO_WAYLAND_XKB
     bool createDefaultKeyMap();
     void releaseKeyMap();
+    void buildKeyTable();
+    const KeyInfo &lookupKey(uint32_t code);
 #endif
+    void queueKeyEvent(QWaylandWindow *window, uint32_t time, QEvent::Type type, int key,
+                       Qt::KeyboardModifiers modifiers, uint32_t code, uint32_t sym,
+                       const QString &text);
 
 };
 
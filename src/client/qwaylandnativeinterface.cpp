@@ -40,6 +40,7 @@
 #include "qwaylandwindowmanagerintegration_p.h"
 #include "qwaylandscreen_p.h"
 #include <QtGui/private/qguiapplication_p.h>
+#include <QtGui/QRegion>
 #include <QtGui/QScreen>
 #include <QtWaylandClient/private/qwaylandclientbufferintegration_p.h>
 
@@ -135,6 +136,16 @@ QVariant QWaylandNativeInterface::windowProperty(QPlatformWindow *window, const
 void QWaylandNativeInterface::setWindowProperty(QPlatformWindow *window, const QString &name, const QVariant &value)
 {
     QWaylandWindow *wlWindow = static_cast<QWaylandWindow*>(window);
+    // Not a window property but the damage of the next OpenGL frame. Qt has
+    // no API that hands the update region of an OpenGL window to the platform
+    // plugin, so applications that know what they repainted report it here
+    // before swapping, as a QRegion in window coordinates. Reports add up
+    // until the next swap, which then only damages that region. Frames
+    // without a report damage the whole window.
+    if (name == QLatin1String("_q_frame_damage")) {
+        wlWindow->addFrameDamage(value.value<QRegion>());
+        return;
+    }
     wlWindow->sendProperty(name, value);
 }
 
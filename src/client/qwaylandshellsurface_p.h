@@ -74,6 +74,7 @@ public:
     virtual void setContentOrientationMask(Qt::ScreenOrientations orientation) { Q_UNUSED(orientation) }
 
     virtual void sendProperty(const QString &name, const QVariant &value);
+    virtual void flushProperties() {}
 
     inline QWaylandWindow *window() { return m_window; }
 
@@ -39,8 +39,8 @@ QT_BEGIN_NAMESPACE
 
 namespace QtWaylandClient {
 
-QWaylandTouchExtension::QWaylandTouchExtension(QWaylandDisplay *display, uint32_t id)
-    : QtWayland::qt_touch_extension(display->wl_registry(), id, 1),
+QWaylandTouchExtension::QWaylandTouchExtension(QWaylandDisplay *display, uint32_t id, int version)
+    : QtWayland::qt_touch_extension(display->wl_registry(), id, qMin(version, 2)),
       mDisplay(display),
       mTouchDevice(0),
       mPointsLeft(0),
@@ -63,18 +63,13 @@ static inline qreal fromFixed(int f)
     return f / qreal(10000);
 }
 
-void QWaylandTouchExtension::touch_extension_touch(uint32_t time,
-                                                   uint32_t id, uint32_t state, int32_t x, int32_t y,
-                                                   int32_t normalized_x, int32_t normalized_y,
-                                                   int32_t width, int32_t height, uint32_t pressure,
-                                                   int32_t velocity_x, int32_t velocity_y,
-                                                   uint32_t flags, wl_array *rawdata)
+bool QWaylandTouchExtension::updateTargetWindow()
 {
     if (!mInputDevice) {
         QList<QWaylandInputDevice *> inputDevices = mDisplay->inputDevices();
         if (inputDevices.isEmpty()) {
             qWarning("qt_touch_extension: handle_touch: No input devices");
-            return;
+            return false;
         }
         mInputDevice = inputDevices.first();
     }
@@ -83,36 +78,70 @@ void QWaylandTouchExtension::touch_extension_touch(uint32_t time,
         win = mInputDevice->pointerFocus();
     if (!win)
         win = mInputDevice->keyboardFocus();
+
+    // Keep key events received earlier in this dispatch ahead of the touch
+    mInputDevice->flushKeyEvents();
+
     if (!win || !win->window()) {
         qWarning("qt_touch_extension: handle_touch: No pointer focus");
-        return;
+        return false;
     }
     mTargetWindow = win->window();
+    return true;
+}
 
+QWindowSystemInterface::TouchPoint QWaylandTouchExtension::touchPoint(uint32_t id, uint32_t state, uint32_t flags,
+                                                                      const PackedPoint &point) const
+{
     QWindowSystemInterface::TouchPoint tp;
     tp.id = id;
-    tp.state = Qt::TouchPointState(int(state & 0xFFFF));
+    tp.state = Qt::TouchPointState(int(state));
+    tp.flags = QTouchEvent::TouchPoint::InfoFlags(int(flags));
+
+    tp.area = QRectF(0, 0, fromFixed(point.w), fromFixed(point.h));
+    // Got surface-relative coords but need a (virtual) screen position.
+    QPointF relPos = QPointF(fromFixed(point.x), fromFixed(point.y));
+    QPointF delta = relPos - relPos.toPoint();
+    tp.area.moveCenter(mTargetWindow->mapToGlobal(relPos.toPoint()) + delta);
+
+    tp.normalPosition.setX(fromFixed(point.nx));
+    tp.normalPosition.setY(fromFixed(point.ny));
+    tp.pressure = point.pressure / 255.0;
+    tp.velocity.setX(fromFixed(point.vx));
+    tp.velocity.setY(fromFixed(point.vy));
+    tp.rawPositions = point.rawPositions;
+    return tp;
+}
+
+void QWaylandTouchExtension::touch_extension_touch(uint32_t time,
+                                                   uint32_t id, uint32_t state, int32_t x, int32_t y,
+                                                   int32_t normalized_x, int32_t normalized_y,
+                                                   int32_t width, int32_t height, uint32_t pressure,
+                                                   int32_t velocity_x, int32_t velocity_y,
+                                                   uint32_t flags, wl_array *rawdata)
+{
+    if (!updateTargetWindow())
+        return;
+
     int sentPointCount = state >> 16;
     if (!mPointsLeft) {
         Q_ASSERT(sentPointCount > 0);
         mPointsLeft = sentPointCount;
     }
-    tp.flags = QTouchEvent::TouchPoint::InfoFlags(int(flags & 0xFFFF));
 
     if (!mTouchDevice)
         registerDevice(flags >> 16);
 
-    tp.area = QRectF(0, 0, fromFixed(width), fromFixed(height));
-    // Got surface-relative coords but need a (virtual) screen position.
-    QPointF relPos = QPointF(fromFixed(x), fromFixed(y));
-    QPointF delta = relPos - relPos.toPoint();
-    tp.area.moveCenter(mTargetWindow->mapToGlobal(relPos.toPoint()) + delta);
-
-    tp.normalPosition.setX(fromFixed(normalized_x));
-    tp.normalPosition.setY(fromFixed(normalized_y));
-    tp.pressure = pressure / 255.0;
-    tp.velocity.setX(fromFixed(velocity_x));
-    tp.velocity.setY(fromFixed(velocity_y));
+    PackedPoint point;
+    point.x = x;
+    point.y = y;
+    point.nx = normalized_x;
+    point.ny = normalized_y;
+    point.w = width;
+    point.h = height;
+    point.pressure = pressure;
+    point.vx = velocity_x;
+    point.vy = velocity_y;
 
     if (rawdata) {
         const int rawPosCount = rawdata->size / sizeof(float) / 2;
@@ -120,17 +149,81 @@ void QWaylandTouchExtension::touch_extension_touch(uint32_t time,
         for (int i = 0; i < rawPosCount; ++i) {
             float x = *p++;
             float y = *p++;
-            tp.rawPositions.append(QPointF(x, y));
+            point.rawPositions.append(QPointF(x, y));
         }
     }
 
-    mTouchPoints.append(tp);
+    mTouchPoints.append(touchPoint(id, state & 0xFFFF, flags & 0xFFFF, point));
     mTimestamp = time;
 
     if (!--mPointsLeft)
         sendTouchEvent();
 }
 
+void QWaylandTouchExtension::touch_extension_touch_frame(uint32_t time, uint32_t flags, wl_array *data)
+{
+    if (!updateTargetWindow())
+        return;
+
+    if (!mTouchDevice)
+        registerDevice(flags);
+
+    const uint32_t *p = static_cast<const uint32_t *>(data->data);
+    const uint32_t *end = p + data->size / sizeof(uint32_t);
+    while (end - p >= 2) {
+        const uint32_t id = *p++;
+        const uint32_t header = *p++;
+        const uint32_t state = header & 0xFF;
+        const uint32_t fields = header >> 16;
+
+        // Fields that are left out keep the value of the previous frame
+        PackedPoint &point = mPackedPoints[id];
+        const int needed = ((fields & QT_TOUCH_EXTENSION_FRAME_FIELD_POSITION) ? 2 : 0)
+                + ((fields & QT_TOUCH_EXTENSION_FRAME_FIELD_NORMALIZED_POSITION) ? 2 : 0)
+                + ((fields & QT_TOUCH_EXTENSION_FRAME_FIELD_SIZE) ? 2 : 0)
+                + ((fields & QT_TOUCH_EXTENSION_FRAME_FIELD_PRESSURE) ? 1 : 0)
+                + ((fields & QT_TOUCH_EXTENSION_FRAME_FIELD_VELOCITY) ? 2 : 0)
+                + ((fields & QT_TOUCH_EXTENSION_FRAME_FIELD_RAW_POSITIONS) ? 1 : 0);
+        if (end - p < needed)
+            break;
+        if (fields & QT_TOUCH_EXTENSION_FRAME_FIELD_POSITION) {
+            point.x = int32_t(*p++);
+            point.y = int32_t(*p++);
+        }
+        if (fields & QT_TOUCH_EXTENSION_FRAME_FIELD_NORMALIZED_POSITION) {
+            point.nx = int32_t(*p++);
+            point.ny = int32_t(*p++);
+        }
+        if (fields & QT_TOUCH_EXTENSION_FRAME_FIELD_SIZE) {
+            point.w = int32_t(*p++);
+            point.h = int32_t(*p++);
+        }
+        if (fields & QT_TOUCH_EXTENSION_FRAME_FIELD_PRESSURE)
+            point.pressure = *p++;
+        if (fields & QT_TOUCH_EXTENSION_FRAME_FIELD_VELOCITY) {
+            point.vx = int32_t(*p++);
+            point.vy = int32_t(*p++);
+        }
+        if (fields & QT_TOUCH_EXTENSION_FRAME_FIELD_RAW_POSITIONS) {
+            const uint32_t rawPosCount = *p++;
+            if (uint32_t(end - p) < rawPosCount * 2)
+                break;
+            const float *raw = reinterpret_cast<const float *>(p);
+            point.rawPositions.resize(rawPosCount);
+            for (uint32_t i = 0; i < rawPosCount; ++i)
+                point.rawPositions[i] = QPointF(raw[2 * i], raw[2 * i + 1]);
+            p += rawPosCount * 2;
+        }
+
+        mTouchPoints.append(touchPoint(id, state, (header >> 8) & 0xFF, point));
+        if (state == Qt::TouchPointReleased)
+            mPackedPoints.remove(id);
+    }
+
+    mTimestamp = time;
+    sendTouchEvent();
+}
+
 void QWaylandTouchExtension::sendTouchEvent()
 {
     // Copy all points, that are in the previous but not in the current list, as stationary.
@@ -192,6 +285,7 @@ void QWaylandTouchExtension::touchCanceled()
 {
     mTouchPoints.clear();
     mPrevTouchPoints.clear();
+    mPackedPoints.clear();
     if (mMouseSourceId != -1)
         QWindowSystemInterface::handleMouseEvent(mTargetWindow, mTimestamp, mLastMouseLocal, mLastMouseGlobal, Qt::NoButton);
 }
@@ -36,6 +36,9 @@
 
 #include <qpa/qwindowsysteminterface.h>
 
+#include <QtCore/QHash>
+#include <QtCore/QVector>
+
 #include <QtWaylandClient/private/qwayland-touch-extension.h>
 #include <QtWaylandClient/private/qwaylandclientexport_p.h>
 
@@ -49,12 +52,25 @@ class QWaylandInputDevice;
 class Q_WAYLAND_CLIENT_EXPORT QWaylandTouchExtension : public QtWayland::qt_touch_extension
 {
 public:
-    QWaylandTouchExtension(QWaylandDisplay *display, uint32_t id);
+    QWaylandTouchExtension(QWaylandDisplay *display, uint32_t id, int version);
 
     void touchCanceled();
 
 private:
+    struct PackedPoint {
+        PackedPoint() : x(0), y(0), nx(0), ny(0), w(0), h(0), pressure(0), vx(0), vy(0) {}
+        int x, y;
+        int nx, ny;
+        int w, h;
+        uint32_t pressure;
+        int vx, vy;
+        QVector<QPointF> rawPositions;
+    };
+
     void registerDevice(int caps);
+    bool updateTargetWindow();
+    QWindowSystemInterface::TouchPoint touchPoint(uint32_t id, uint32_t state, uint32_t flags,
+                                                  const PackedPoint &point) const;
 
     QWaylandDisplay *mDisplay;
 
@@ -73,6 +89,7 @@ private:
                                uint32_t flags,
                                struct wl_array *rawdata) Q_DECL_OVERRIDE;
     void touch_extension_configure(uint32_t flags) Q_DECL_OVERRIDE;
+    void touch_extension_touch_frame(uint32_t time, uint32_t flags, struct wl_array *data) Q_DECL_OVERRIDE;
 
     void sendTouchEvent();
 
@@ -87,6 +104,8 @@ private:
     QPointF mLastMouseGlobal;
     QWindow *mTargetWindow;
     QWaylandInputDevice *mInputDevice;
+    // Last values received in touch frames for the points that are down
+    QHash<int, PackedPoint> mPackedPoints;
 };
 
 }
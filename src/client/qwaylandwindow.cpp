@@ -54,15 +54,24 @@
 
 #include <QGuiApplication>
 #include <qpa/qwindowsysteminterface.h>
+#include <QtGui/private/qwindow_p.h>
 
 #include <QtCore/QDebug>
 
+#include <wayland-version.h>
+
 QT_BEGIN_NAMESPACE
 
 namespace QtWaylandClient {
 
 QWaylandWindow *QWaylandWindow::mMouseGrab = 0;
 
+// The compositor does not send frame callbacks for surfaces it does not show,
+// so one that takes this long is given up on
+static const int frameLostTimeout = 1000;
+// Longest a renderer waits for the previous frame before it goes on anyway
+static const int frameSyncTimeout = 100;
+
 QWaylandWindow::QWaylandWindow(QWindow *window)
     : QObject()
     , QPlatformWindow(window)
@@ -75,8 +84,10 @@ QWaylandWindow::QWaylandWindow(QWindow *window)
     , mMousePressedInContentArea(Qt::NoButton)
     , m_cursorShape(Qt::ArrowCursor)
     , mBuffer(0)
+    , mFrameQueue(wl_display_create_queue(mDisplay->wl_display()))
     , mWaitingForFrameSync(false)
     , mFrameCallback(0)
+    , mUpdateRequested(false)
     , mRequestResizeSent(false)
     , mCanResize(true)
     , mResizeDirty(false)
@@ -89,6 +100,11 @@ QWaylandWindow::QWaylandWindow(QWindow *window)
     static WId id = 1;
     mWindowId = id++;
 
+    mDisplay->addFrameQueue(mFrameQueue);
+
+    mFrameLostTimer.setSingleShot(true);
+    connect(&mFrameLostTimer, SIGNAL(timeout()), this, SLOT(frameLost()));
+
     initWindow();
 }
 
@@ -99,6 +115,9 @@ QWaylandWindow::~QWaylandWindow()
     if (isInitialized())
         reset();
 
+    mDisplay->removeFrameQueue(mFrameQueue);
+    wl_event_queue_destroy(mFrameQueue);
+
     QList<QWaylandInputDevice *> inputDevices = mDisplay->inputDevices();
     for (int i = 0; i < inputDevices.size(); ++i)
         inputDevices.at(i)->handleWindowDestroyed(this);
@@ -183,8 +202,13 @@ void QWaylandWindow::reset()
     mSubSurfaceWindow = 0;
     destroy();
 
-    if (mFrameCallback)
+    QMutexLocker lock(&mFrameSyncMutex);
+    if (mFrameCallback) {
         wl_callback_destroy(mFrameCallback);
+        mFrameCallback = 0;
+    }
+    mWaitingForFrameSync = false;
+    mFrameSyncWait.wakeAll();
 }
 
 QWaylandWindow *QWaylandWindow::fromWlSurface(::wl_surface *surface)
@@ -431,43 +455,145 @@ void QWaylandWindow::damage(const QRect &rect)
 {
     //We have to do sync stuff before calling damage, or we might
     //get a frame callback before we get the timestamp
-    if (!mWaitingForFrameSync) {
-        mFrameCallback = frame();
-        wl_callback_add_listener(mFrameCallback,&QWaylandWindow::callbackListener,this);
-        mWaitingForFrameSync = true;
-    }
+    requestFrame();
     if (mBuffer) {
         damage(rect.x(), rect.y(), rect.width(), rect.height());
     }
 }
 
+// Parts of the window, in window coordinates, that the application repainted
+// for the next frame. OpenGL windows report it when swapping; a frame without
+// any is taken as fully damaged.
+void QWaylandWindow::addFrameDamage(const QRegion &region)
+{
+    QMutexLocker lock(&mFrameDamageLock);
+    mFrameDamage += region;
+}
+
+QRegion QWaylandWindow::takeFrameDamage()
+{
+    QMutexLocker lock(&mFrameDamageLock);
+    QRegion damage = mFrameDamage;
+    mFrameDamage = QRegion();
+    return damage;
+}
+
+// Must be called with mFrameSyncMutex held
+bool QWaylandWindow::frameCallbackPending()
+{
+    if (mWaitingForFrameSync && mFrameCallbackTimer.elapsed() > frameLostTimeout) {
+        wl_callback_destroy(mFrameCallback);
+        mFrameCallback = 0;
+        mWaitingForFrameSync = false;
+        mFrameSyncWait.wakeAll();
+        if (mUpdateRequested) {
+            mUpdateRequested = false;
+            QMetaObject::invokeMethod(this, "deliverUpdateRequest", Qt::QueuedConnection);
+        }
+    }
+    return mWaitingForFrameSync;
+}
+
+// Asks for a frame callback with the next commit, unless one is already
+// outstanding
+void QWaylandWindow::requestFrame()
+{
+    QMutexLocker lock(&mFrameSyncMutex);
+    if (frameCallbackPending())
+        return;
+
+#if WAYLAND_VERSION_MAJOR > 1 || (WAYLAND_VERSION_MAJOR == 1 && WAYLAND_VERSION_MINOR >= 11)
+    // Requested through a wrapper, the callback is created on the frame queue
+    // and never sits on the default queue of the event thread
+    struct ::wl_surface *wrapper = static_cast<struct ::wl_surface *>(wl_proxy_create_wrapper(object()));
+    wl_proxy_set_queue(reinterpret_cast<wl_proxy *>(wrapper), mFrameQueue);
+    mFrameCallback = wl_surface_frame(wrapper);
+    wl_proxy_wrapper_destroy(wrapper);
+#else
+    // The callback starts out on the default queue. That is only safe because
+    // its done event follows the next commit, which comes after the move.
+    mFrameCallback = frame();
+    wl_proxy_set_queue(reinterpret_cast<wl_proxy *>(mFrameCallback), mFrameQueue);
+#endif
+    wl_callback_add_listener(mFrameCallback, &QWaylandWindow::callbackListener, this);
+    mFrameCallbackTimer.start();
+    mWaitingForFrameSync = true;
+
+    // Requested on render threads too, while the timer lives on the GUI thread
+    QMetaObject::invokeMethod(&mFrameLostTimer, "start", Qt::AutoConnection, Q_ARG(int, frameLostTimeout));
+}
+
+// Gives up on a lost frame callback even when nothing else checks on it, so
+// that an update request held back for it is still delivered
+void QWaylandWindow::frameLost()
+{
+    QMutexLocker lock(&mFrameSyncMutex);
+    if (!frameCallbackPending())
+        return;
+
+    // Timers may fire a little early
+    mFrameLostTimer.start(qMax(frameLostTimeout - int(mFrameCallbackTimer.elapsed()), 1));
+}
+
 const wl_callback_listener QWaylandWindow::callbackListener = {
     QWaylandWindow::frameCallback
 };
 
+// Called on the event thread, which dispatches the frame queues
 void QWaylandWindow::frameCallback(void *data, struct wl_callback *callback, uint32_t time)
 {
     Q_UNUSED(time);
     QWaylandWindow *self = static_cast<QWaylandWindow*>(data);
-    if (callback != self->mFrameCallback) // might be a callback caused by the shm backingstore
+    QMutexLocker lock(&self->mFrameSyncMutex);
+    if (callback != self->mFrameCallback) // given up on already
         return;
+    wl_callback_destroy(callback);
+    self->mFrameCallback = 0;
     self->mWaitingForFrameSync = false;
-    if (self->mFrameCallback) {
-        wl_callback_destroy(self->mFrameCallback);
-        self->mFrameCallback = 0;
+    self->mFrameSyncWait.wakeAll();
+
+    if (self->mUpdateRequested) {
+        self->mUpdateRequested = false;
+        QMetaObject::invokeMethod(self, "deliverUpdateRequest", Qt::QueuedConnection);
     }
 }
 
-QMutex QWaylandWindow::mFrameSyncMutex;
-
+// Waits for the frame callback of this window only, whichever thread renders
+// it. No queue but the window's own is touched here.
 void QWaylandWindow::waitForFrameSync()
 {
-    QMutexLocker locker(&mFrameSyncMutex);
+    // The callback may have been read by a render thread reading the display
+    // for its own queues, in which case nobody else would dispatch it soon
+    wl_display_dispatch_queue_pending(mDisplay->wl_display(), mFrameQueue);
+
+    QMutexLocker lock(&mFrameSyncMutex);
     if (!mWaitingForFrameSync)
         return;
-    mDisplay->flushRequests();
-    while (mWaitingForFrameSync)
-        mDisplay->blockingReadEvents();
+
+    wl_display_flush(mDisplay->wl_display());
+    while (frameCallbackPending()) {
+        if (!mFrameSyncWait.wait(&mFrameSyncMutex, frameSyncTimeout))
+            break;
+    }
+}
+
+// While a frame is outstanding update requests are held back until it is
+// done, so that rendering follows the compositor without ever blocking
+void QWaylandWindow::requestUpdate()
+{
+    QMutexLocker lock(&mFrameSyncMutex);
+    if (frameCallbackPending()) {
+        mUpdateRequested = true;
+        return;
+    }
+    lock.unlock();
+
+    QPlatformWindow::requestUpdate();
+}
+
+void QWaylandWindow::deliverUpdateRequest()
+{
+    QWindowPrivate::get(window())->deliverUpdateRequest();
 }
 
 QMargins QWaylandWindow::frameMargins() const
@@ -746,7 +872,13 @@ void QWaylandWindow::setMouseCursor(QWaylandInputDevice *device, Qt::CursorShape
 
 void QWaylandWindow::restoreMouseCursor(QWaylandInputDevice *device)
 {
-    setMouseCursor(device, window()->cursor().shape());
+    const QCursor cursor = window()->cursor();
+    if (cursor.shape() == Qt::BitmapCursor) {
+        device->setCursor(cursor, mScreen);
+        m_cursorShape = Qt::BitmapCursor;
+    } else {
+        setMouseCursor(device, cursor.shape());
+    }
 }
 
 void QWaylandWindow::requestActivateWindow()
@@ -832,6 +964,20 @@ void QWaylandWindow::sendProperty(const QString &name, const QVariant &value)
         mShellSurface->sendProperty(name, value);
 }
 
+// Sends the window properties changed since the last commit, so that they
+// apply together with the contents they were set for
+void QWaylandWindow::flushProperties()
+{
+    if (mShellSurface)
+        mShellSurface->flushProperties();
+}
+
+void QWaylandWindow::commit()
+{
+    flushProperties();
+    QtWayland::wl_surface::commit();
+}
+
 void QWaylandWindow::setProperty(const QString &name, const QVariant &value)
 {
     m_properties.insert(name, value);
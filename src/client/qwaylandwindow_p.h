@@ -36,6 +36,8 @@
 
 #include <QtCore/QWaitCondition>
 #include <QtCore/QMutex>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QTimer>
 #include <QtGui/QIcon>
 #include <QtCore/QVariant>
 
@@ -115,7 +117,12 @@ public:
     using QtWayland::wl_surface::damage;
     void damage(const QRect &rect);
 
+    void addFrameDamage(const QRegion &region);
+    QRegion takeFrameDamage();
+
+    void requestFrame();
     void waitForFrameSync();
+    void requestUpdate() Q_DECL_OVERRIDE;
 
     QMargins frameMargins() const;
 
@@ -170,6 +177,8 @@ public:
     static QWaylandWindow *mouseGrab() { return mMouseGrab; }
 
     void sendProperty(const QString &name, const QVariant &value);
+    void flushProperties();
+    void commit();
     void setProperty(const QString &name, const QVariant &value);
 
     QVariantMap properties() const;
@@ -185,6 +194,10 @@ public:
 public slots:
     void requestResize();
 
+private slots:
+    void deliverUpdateRequest();
+    void frameLost();
+
 protected:
     QWaylandScreen *mScreen;
     QWaylandDisplay *mDisplay;
@@ -199,9 +212,16 @@ protected:
 
     QWaylandBuffer *mBuffer;
     WId mWindowId;
+    // Frame callbacks are delivered on a queue of the window's own, so that
+    // waiting for one neither takes the GUI thread's queue nor other windows
+    QMutex mFrameSyncMutex;
+    QWaitCondition mFrameSyncWait;
+    struct ::wl_event_queue *mFrameQueue;
     bool mWaitingForFrameSync;
     struct wl_callback *mFrameCallback;
-    QWaitCondition mFrameSyncWait;
+    QElapsedTimer mFrameCallbackTimer;
+    QTimer mFrameLostTimer;
+    bool mUpdateRequested;
 
     QMutex mResizeLock;
     QWaylandWindowConfigure mConfigure;
@@ -219,6 +239,9 @@ protected:
     Qt::WindowState mState;
     QRegion mMask;
 
+    QMutex mFrameDamageLock;
+    QRegion mFrameDamage;
+
     QWaylandShmBackingStore *mBackingStore;
 
 private:
@@ -229,10 +252,11 @@ private:
 
     void handleMouseEventWithDecoration(QWaylandInputDevice *inputDevice, const QWaylandPointerEvent &e);
 
+    bool frameCallbackPending();
+
     static const wl_callback_listener callbackListener;
     static void frameCallback(void *data, struct wl_callback *wl_callback, uint32_t time);
 
-    static QMutex mFrameSyncMutex;
     static QWaylandWindow *mMouseGrab;
 
     friend class QWaylandSubSurface;
@@ -117,6 +117,12 @@ void QWaylandWlShellSurface::sendProperty(const QString &name, const QVariant &v
         m_extendedWindow->updateGenericProperty(name, value);
 }
 
+void QWaylandWlShellSurface::flushProperties()
+{
+    if (m_extendedWindow)
+        m_extendedWindow->flushProperties();
+}
+
 void QWaylandWlShellSurface::setMaximized()
 {
     m_maximized = true;
@@ -74,6 +74,7 @@ public:
     void setContentOrientationMask(Qt::ScreenOrientations orientation) Q_DECL_OVERRIDE;
     void setWindowFlags(Qt::WindowFlags flags) Q_DECL_OVERRIDE;
     void sendProperty(const QString &name, const QVariant &value) Q_DECL_OVERRIDE;
+    void flushProperties() Q_DECL_OVERRIDE;
 
 private:
     void setMaximized() Q_DECL_OVERRIDE;
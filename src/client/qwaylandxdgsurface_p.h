@@ -77,6 +77,7 @@ public:
     void setContentOrientationMask(Qt::ScreenOrientations orientation) Q_DECL_OVERRIDE;
     void setWindowFlags(Qt::WindowFlags flags) Q_DECL_OVERRIDE;
     void sendProperty(const QString &name, const QVariant &value) Q_DECL_OVERRIDE;
+    void flushProperties() Q_DECL_OVERRIDE;
 
     bool isFullscreen() const { return m_fullscreen; }
     bool isMaximized() const { return m_maximized; }
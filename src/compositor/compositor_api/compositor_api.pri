@@ -8,6 +8,9 @@ HEADERS += \
     compositor_api/qwaylandinput.h \
     compositor_api/qwaylandinputpanel.h \
     compositor_api/qwaylandoutput.h \
+    compositor_api/qwaylandsoftwareoutput.h \
+    compositor_api/qwaylandoutputcapture.h \
+    compositor_api/qwaylandoutputdamage.h \
     compositor_api/qwaylanddrag.h \
     compositor_api/qwaylandbufferref.h \
     compositor_api/qwaylandsurfaceview.h \
@@ -21,6 +24,9 @@ SOURCES += \
     compositor_api/qwaylandinput.cpp \
     compositor_api/qwaylandinputpanel.cpp \
     compositor_api/qwaylandoutput.cpp \
+    compositor_api/qwaylandsoftwareoutput.cpp \
+    compositor_api/qwaylandoutputcapture.cpp \
+    compositor_api/qwaylandoutputdamage.cpp \
     compositor_api/qwaylanddrag.cpp \
     compositor_api/qwaylandbufferref.cpp \
     compositor_api/qwaylandsurfaceview.cpp \
@@ -29,6 +35,11 @@ SOURCES += \
 
 QT += core-private
 
+contains(DEFINES, QT_COMPOSITOR_WAYLAND_GL) {
+    HEADERS += compositor_api/qwaylandbatchrenderer.h
+    SOURCES += compositor_api/qwaylandbatchrenderer.cpp
+}
+
 qtHaveModule(quick) {
     SOURCES += \
         compositor_api/qwaylandquickcompositor.cpp \
@@ -0,0 +1,694 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the plugins of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qwaylandbatchrenderer.h"
+
+#include "qwaylandbufferref.h"
+#include "qwaylandoutput.h"
+#include "qwaylandsurface.h"
+#include "qwaylandsurfaceview.h"
+
+#include "wayland_wrapper/qwlsurface_p.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QSet>
+#include <QtCore/QVector>
+#include <QtGui/QMatrix4x4>
+#include <QtGui/QOpenGLContext>
+#include <QtGui/QOpenGLFunctions>
+#include <QtGui/QOpenGLShaderProgram>
+
+#include <algorithm>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QWaylandBatchRenderer
+    \brief Draws the views of an output with OpenGL in as few draw calls as possible.
+
+    QWaylandBatchRenderer keeps a texture for every surface it draws and only
+    uploads the damaged parts of SHM buffers. SHM surfaces no larger than
+    maxAtlasSurfaceSize() share one atlas texture, so a scene of many small
+    surfaces such as tray icons, tooltips or OSDs needs a single texture bind.
+
+    Views are drawn bottom-most first, subsurfaces above their parent. A view
+    using the same texture as an earlier draw call is merged into it, unless
+    something drawn in between overlaps the view.
+
+    The OpenGL context used for rendering must be current when calling
+    render() and releaseResources(), and releaseResources() must be called
+    before the renderer is destroyed.
+*/
+
+static const char *vertexShaderSource =
+        "uniform highp mat4 matrix;\n"
+        "attribute highp vec2 vertexCoord;\n"
+        "attribute highp vec2 textureCoord;\n"
+        "varying highp vec2 fragTextureCoord;\n"
+        "void main() {\n"
+        "   fragTextureCoord = textureCoord;\n"
+        "   gl_Position = matrix * vec4(vertexCoord, 0.0, 1.0);\n"
+        "}\n";
+
+static const char *fragmentShaderSource =
+        "uniform sampler2D surfaceTexture;\n"
+        "varying highp vec2 fragTextureCoord;\n"
+        "void main() {\n"
+        "   gl_FragColor = texture2D(surfaceTexture, fragTextureCoord);\n"
+        "}\n";
+
+enum {
+    VertexCoordAttribute = 0,
+    TextureCoordAttribute = 1,
+    FloatsPerVertex = 4
+};
+
+struct SurfaceTexture
+{
+    SurfaceTexture()
+        : texture(0)
+        , inAtlas(false)
+    {
+    }
+
+    // Texture of its own, 0 for atlas entries and for entries still waiting
+    // for atlas space
+    GLuint texture;
+    bool inAtlas;
+    QRect atlasRect;
+    QSize size;
+    // Surface damage not uploaded yet
+    QRegion damage;
+};
+
+struct SceneItem
+{
+    QWaylandSurface *surface;
+    QRect geometry;
+};
+
+struct Batch
+{
+    GLuint texture;
+    QRegion bounds;
+    QVector<GLfloat> vertices;
+};
+
+struct AtlasShelf
+{
+    int y;
+    int height;
+    int x;
+};
+
+class QWaylandBatchRendererPrivate
+{
+public:
+    QWaylandBatchRendererPrivate(QWaylandOutput *o)
+        : output(o)
+        , clearColor(Qt::black)
+        , atlasSize(1024, 1024)
+        , maxAtlasSurfaceSize(128, 128)
+        , gl(Q_NULLPTR)
+        , program(Q_NULLPTR)
+        , atlasTexture(0)
+        , atlasShelfY(0)
+        , drawCallCount(0)
+    {
+    }
+
+    void initialize();
+    GLuint createTexture(const QSize &size);
+    bool fitsAtlas(const QSize &size) const;
+    bool allocateInAtlas(const QSize &size, QRect *rect);
+    void repackAtlas();
+    void clearAtlas();
+    void addSurface(QWaylandSurface *surface, const QPoint &position, const QRect &clip);
+    bool allocate(QWaylandSurface *surface, const QSize &size, bool atlasRepacked);
+    bool prepare(QWaylandSurface *surface, GLuint *texture, QRectF *source);
+    void upload(GLuint texture, const QImage &image, const QRect &rect, const QPoint &target);
+    void addQuad(GLuint texture, const QRect &geometry, const QRectF &source);
+
+    QWaylandOutput *output;
+    QColor clearColor;
+    QSize atlasSize;
+    QSize maxAtlasSurfaceSize;
+
+    QOpenGLFunctions *gl;
+    QOpenGLShaderProgram *program;
+    int matrixLocation;
+    int textureLocation;
+
+    GLuint atlasTexture;
+    QSize atlasTextureSize;
+    QVector<AtlasShelf> atlasShelves;
+    int atlasShelfY;
+
+    QHash<QWaylandSurface *, SurfaceTexture> textures;
+    // Textures released while no context was current
+    QVector<GLuint> orphanedTextures;
+
+    QVector<SceneItem> items;
+    QVector<Batch> batches;
+    int drawCallCount;
+};
+
+void QWaylandBatchRendererPrivate::initialize()
+{
+    if (!orphanedTextures.isEmpty()) {
+        gl->glDeleteTextures(orphanedTextures.size(), orphanedTextures.constData());
+        orphanedTextures.clear();
+    }
+
+    if (!program) {
+        program = new QOpenGLShaderProgram;
+        program->addShaderFromSourceCode(QOpenGLShader::Vertex, vertexShaderSource);
+        program->addShaderFromSourceCode(QOpenGLShader::Fragment, fragmentShaderSource);
+        program->bindAttributeLocation("vertexCoord", VertexCoordAttribute);
+        program->bindAttributeLocation("textureCoord", TextureCoordAttribute);
+        if (!program->link())
+            qWarning("QWaylandBatchRenderer: failed to link the shader program: %s", qPrintable(program->log()));
+        matrixLocation = program->uniformLocation("matrix");
+        textureLocation = program->uniformLocation("surfaceTexture");
+    }
+
+    if (atlasTexture && atlasTextureSize != atlasSize) {
+        gl->glDeleteTextures(1, &atlasTexture);
+        atlasTexture = 0;
+        clearAtlas();
+    }
+    if (!atlasTexture) {
+        atlasTexture = createTexture(atlasSize);
+        atlasTextureSize = atlasSize;
+    }
+}
+
+GLuint QWaylandBatchRendererPrivate::createTexture(const QSize &size)
+{
+    GLuint texture = 0;
+    gl->glGenTextures(1, &texture);
+    gl->glBindTexture(GL_TEXTURE_2D, texture);
+    gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    gl->glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size.width(), size.height(), 0,
+                     GL_RGBA, GL_UNSIGNED_BYTE, Q_NULLPTR);
+    return texture;
+}
+
+bool QWaylandBatchRendererPrivate::fitsAtlas(const QSize &size) const
+{
+    return size.width() <= maxAtlasSurfaceSize.width() && size.height() <= maxAtlasSurfaceSize.height();
+}
+
+bool QWaylandBatchRendererPrivate::allocateInAtlas(const QSize &size, QRect *rect)
+{
+    // Shelf packing: entries go on the first shelf that is tall enough
+    // without wasting more than half of its height
+    for (int i = 0; i < atlasShelves.size(); ++i) {
+        AtlasShelf &shelf = atlasShelves[i];
+        if (size.height() <= shelf.height && size.height() * 2 >= shelf.height
+                && shelf.x + size.width() <= atlasSize.width()) {
+            *rect = QRect(QPoint(shelf.x, shelf.y), size);
+            shelf.x += size.width();
+            return true;
+        }
+    }
+
+    if (size.width() > atlasSize.width() || atlasShelfY + size.height() > atlasSize.height())
+        return false;
+
+    AtlasShelf shelf = { atlasShelfY, size.height(), size.width() };
+    atlasShelves.append(shelf);
+    *rect = QRect(QPoint(0, atlasShelfY), size);
+    atlasShelfY += size.height();
+    return true;
+}
+
+static bool tallerEntry(const SurfaceTexture *a, const SurfaceTexture *b)
+{
+    return a->size.height() > b->size.height();
+}
+
+void QWaylandBatchRendererPrivate::repackAtlas()
+{
+    // Entries of destroyed or resized surfaces leave holes behind that are
+    // only reclaimed by packing the atlas from scratch. The surfaces of the
+    // frame being rendered go first, so they never lose their place to
+    // surfaces that are not shown.
+    atlasShelves.clear();
+    atlasShelfY = 0;
+
+    QSet<QWaylandSurface *> shown;
+    foreach (const SceneItem &item, items)
+        shown.insert(item.surface);
+
+    QVector<SurfaceTexture *> current;
+    QVector<SurfaceTexture *> others;
+    for (QHash<QWaylandSurface *, SurfaceTexture>::iterator it = textures.begin(); it != textures.end(); ++it) {
+        if (shown.contains(it.key())) {
+            if (!it->texture && !it->size.isEmpty())
+                current << &it.value();
+        } else if (it->inAtlas) {
+            others << &it.value();
+        }
+    }
+    std::sort(current.begin(), current.end(), tallerEntry);
+    std::sort(others.begin(), others.end(), tallerEntry);
+
+    // Shown surfaces that do not fit get a texture of their own
+    foreach (SurfaceTexture *entry, current) {
+        entry->inAtlas = allocateInAtlas(entry->size, &entry->atlasRect);
+        entry->damage = QRect(QPoint(), entry->size);
+    }
+
+    foreach (SurfaceTexture *entry, others) {
+        if (allocateInAtlas(entry->size, &entry->atlasRect)) {
+            entry->damage = QRect(QPoint(), entry->size);
+        } else {
+            // Allocated again on its next use
+            *entry = SurfaceTexture();
+        }
+    }
+}
+
+void QWaylandBatchRendererPrivate::clearAtlas()
+{
+    atlasShelves.clear();
+    atlasShelfY = 0;
+    for (QHash<QWaylandSurface *, SurfaceTexture>::iterator it = textures.begin(); it != textures.end(); ++it) {
+        if (it->inAtlas)
+            *it = SurfaceTexture();
+    }
+}
+
+void QWaylandBatchRendererPrivate::addSurface(QWaylandSurface *surface, const QPoint &position, const QRect &clip)
+{
+    const QRect geometry(position, surface->size());
+    if (geometry.intersects(clip)) {
+        SceneItem item = { surface, geometry };
+        items << item;
+    }
+
+    foreach (QWaylandSurface *child, surface->subSurfaces()) {
+        if (!child->isMapped() || child->views().isEmpty())
+            continue;
+        addSurface(child, position + child->views().first()->pos().toPoint(), clip);
+    }
+}
+
+/*
+    Returns false if the surface has to wait for the atlas to be packed again.
+    Once \a atlasRepacked, surfaces that still do not fit get a texture of
+    their own.
+*/
+bool QWaylandBatchRendererPrivate::allocate(QWaylandSurface *surface, const QSize &size, bool atlasRepacked)
+{
+    SurfaceTexture &entry = textures[surface];
+    if (size.isEmpty())
+        return true;
+
+    if (entry.size != size) {
+        if (entry.texture) {
+            gl->glDeleteTextures(1, &entry.texture);
+            entry.texture = 0;
+        }
+        entry.size = size;
+        entry.damage = QRect(QPoint(), size);
+        entry.inAtlas = fitsAtlas(size) && allocateInAtlas(size, &entry.atlasRect);
+    }
+
+    if (entry.inAtlas || entry.texture)
+        return true;
+    if (fitsAtlas(size) && !atlasRepacked)
+        return false;
+    entry.texture = createTexture(size);
+    return true;
+}
+
+bool QWaylandBatchRendererPrivate::prepare(QWaylandSurface *surface, GLuint *texture, QRectF *source)
+{
+    QWaylandBufferRef buffer = surface->handle()->currentBuffer();
+    if (!buffer)
+        return false;
+
+    if (!buffer.isShm()) {
+        *texture = buffer.createTexture();
+        *source = surface->isYInverted() ? QRectF(0, 0, 1, 1) : QRectF(0, 1, 1, -1);
+        return *texture != 0;
+    }
+
+    QHash<QWaylandSurface *, SurfaceTexture>::iterator entry = textures.find(surface);
+    if (entry == textures.end() || entry->size.isEmpty())
+        return false;
+
+    const QImage image = buffer.image();
+    if (!entry->damage.isEmpty()) {
+        // Damage is in surface coordinates, which only match the buffer at scale 1
+        QRect rect = QRect(QPoint(), entry->size);
+        if (image.size() == surface->size())
+            rect &= entry->damage.boundingRect();
+        if (entry->inAtlas)
+            upload(atlasTexture, image, rect, entry->atlasRect.topLeft() + rect.topLeft());
+        else
+            upload(entry->texture, image, rect, rect.topLeft());
+        entry->damage = QRegion();
+    }
+
+    // SHM contents are uploaded top row first
+    if (entry->inAtlas) {
+        const qreal width = atlasTextureSize.width();
+        const qreal height = atlasTextureSize.height();
+        *texture = atlasTexture;
+        *source = QRectF(entry->atlasRect.x() / width, entry->atlasRect.y() / height,
+                         entry->atlasRect.width() / width, entry->atlasRect.height() / height);
+    } else {
+        *texture = entry->texture;
+        *source = QRectF(0, 0, 1, 1);
+    }
+    return true;
+}
+
+void QWaylandBatchRendererPrivate::upload(GLuint texture, const QImage &image, const QRect &rect, const QPoint &target)
+{
+    if (rect.isEmpty())
+        return;
+
+    const QImage data = image.copy(rect).convertToFormat(QImage::Format_RGBA8888_Premultiplied);
+    gl->glBindTexture(GL_TEXTURE_2D, texture);
+    gl->glTexSubImage2D(GL_TEXTURE_2D, 0, target.x(), target.y(), rect.width(), rect.height(),
+                        GL_RGBA, GL_UNSIGNED_BYTE, data.constBits());
+}
+
+void QWaylandBatchRendererPrivate::addQuad(GLuint texture, const QRect &geometry, const QRectF &source)
+{
+    // Join the latest draw call with the same texture, as long as nothing
+    // drawn after it would end up below this quad
+    int target = -1;
+    for (int i = batches.size() - 1; i >= 0; --i) {
+        if (batches.at(i).texture == texture) {
+            target = i;
+            break;
+        }
+        if (batches.at(i).bounds.intersects(geometry))
+            break;
+    }
+    if (target < 0) {
+        Batch batch;
+        batch.texture = texture;
+        batches.append(batch);
+        target = batches.size() - 1;
+    }
+
+    Batch &batch = batches[target];
+    batch.bounds += geometry;
+
+    const GLfloat x1 = geometry.x();
+    const GLfloat y1 = geometry.y();
+    const GLfloat x2 = geometry.x() + geometry.width();
+    const GLfloat y2 = geometry.y() + geometry.height();
+    const GLfloat s1 = source.left();
+    const GLfloat t1 = source.top();
+    const GLfloat s2 = source.right();
+    const GLfloat t2 = source.bottom();
+    const GLfloat vertices[] = {
+        x1, y1, s1, t1,
+        x2, y1, s2, t1,
+        x2, y2, s2, t2,
+        x1, y1, s1, t1,
+        x2, y2, s2, t2,
+        x1, y2, s1, t2
+    };
+    for (size_t i = 0; i < sizeof(vertices) / sizeof(vertices[0]); ++i)
+        batch.vertices << vertices[i];
+}
+
+QWaylandBatchRenderer::QWaylandBatchRenderer(QWaylandOutput *output)
+    : QObject(output)
+    , d(new QWaylandBatchRendererPrivate(output))
+{
+}
+
+QWaylandBatchRenderer::~QWaylandBatchRenderer()
+{
+    if (d->program || d->atlasTexture)
+        qWarning("QWaylandBatchRenderer::releaseResources() must be called before destroying the renderer");
+    delete d;
+}
+
+QWaylandOutput *QWaylandBatchRenderer::output() const
+{
+    return d->output;
+}
+
+/*!
+    Returns the color the repainted area is cleared with before the views are
+    drawn. The default is black.
+*/
+QColor QWaylandBatchRenderer::clearColor() const
+{
+    return d->clearColor;
+}
+
+void QWaylandBatchRenderer::setClearColor(const QColor &color)
+{
+    d->clearColor = color;
+}
+
+/*!
+    Returns the size of the texture shared by small SHM surfaces. The default
+    is 1024x1024.
+*/
+QSize QWaylandBatchRenderer::atlasSize() const
+{
+    return d->atlasSize;
+}
+
+void QWaylandBatchRenderer::setAtlasSize(const QSize &size)
+{
+    d->atlasSize = size;
+}
+
+/*!
+    Returns the largest SHM surface that is put into the atlas. Bigger surfaces
+    get a texture of their own. The default is 128x128.
+*/
+QSize QWaylandBatchRenderer::maxAtlasSurfaceSize() const
+{
+    return d->maxAtlasSurfaceSize;
+}
+
+void QWaylandBatchRenderer::setMaxAtlasSurfaceSize(const QSize &size)
+{
+    if (d->maxAtlasSurfaceSize == size)
+        return;
+
+    d->maxAtlasSurfaceSize = size;
+
+    // Place every surface again on the next frame
+    for (QHash<QWaylandSurface *, SurfaceTexture>::iterator it = d->textures.begin(); it != d->textures.end(); ++it) {
+        if (it->texture)
+            d->orphanedTextures << it->texture;
+        *it = SurfaceTexture();
+    }
+    d->atlasShelves.clear();
+    d->atlasShelfY = 0;
+}
+
+/*!
+    Draws \a views, bottom-most first, into the current framebuffer, which is
+    expected to have the size of the output. View positions are in compositor
+    coordinates.
+
+    If \a damage is not empty, only its bounding rectangle is repainted and
+    views outside of it are skipped. The rest of the framebuffer is left
+    untouched.
+*/
+void QWaylandBatchRenderer::render(const QList<QWaylandSurfaceView *> &views, const QRegion &damage)
+{
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    if (!context) {
+        qWarning("QWaylandBatchRenderer::render() needs a current OpenGL context");
+        return;
+    }
+    d->gl = context->functions();
+    d->initialize();
+
+    const QSize size = d->output->geometry().size();
+    QRect clip(QPoint(), size);
+    if (!damage.isEmpty())
+        clip &= damage.boundingRect();
+    d->drawCallCount = 0;
+    if (clip.isEmpty())
+        return;
+
+    const QPoint origin = d->output->position();
+    d->items.clear();
+    foreach (QWaylandSurfaceView *view, views)
+        d->addSurface(view->surface(), view->pos().toPoint() - origin, clip);
+
+    // Make room for all textures before uploading anything, since running
+    // out of atlas space moves the entries already in it
+    bool atlasFull = false;
+    foreach (const SceneItem &item, d->items) {
+        QWaylandSurface *surface = item.surface;
+        QWaylandBufferRef buffer = surface->handle()->currentBuffer();
+        if (!buffer || !buffer.isShm())
+            continue;
+        if (!d->textures.contains(surface)) {
+            connect(surface, &QWaylandSurface::damaged, this, &QWaylandBatchRenderer::surfaceDamaged,
+                    Qt::UniqueConnection);
+            connect(surface, &QObject::destroyed, this, &QWaylandBatchRenderer::surfaceObjectDestroyed,
+                    Qt::UniqueConnection);
+        }
+        if (!d->allocate(surface, buffer.image().size(), false))
+            atlasFull = true;
+    }
+    if (atlasFull) {
+        d->repackAtlas();
+        foreach (const SceneItem &item, d->items) {
+            if (d->textures.contains(item.surface))
+                d->allocate(item.surface, d->textures.value(item.surface).size, true);
+        }
+    }
+
+    foreach (const SceneItem &item, d->items) {
+        GLuint texture = 0;
+        QRectF source;
+        if (d->prepare(item.surface, &texture, &source))
+            d->addQuad(texture, item.geometry, source);
+    }
+
+    QOpenGLFunctions *gl = d->gl;
+    gl->glViewport(0, 0, size.width(), size.height());
+    gl->glEnable(GL_SCISSOR_TEST);
+    gl->glScissor(clip.x(), size.height() - clip.y() - clip.height(), clip.width(), clip.height());
+    gl->glClearColor(d->clearColor.redF(), d->clearColor.greenF(), d->clearColor.blueF(), d->clearColor.alphaF());
+    gl->glClear(GL_COLOR_BUFFER_BIT);
+
+    if (!d->batches.isEmpty()) {
+        // Everything is drawn with premultiplied alpha
+        gl->glEnable(GL_BLEND);
+        gl->glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+        QMatrix4x4 matrix;
+        matrix.ortho(0, size.width(), size.height(), 0, -1, 1);
+        d->program->bind();
+        d->program->setUniformValue(d->matrixLocation, matrix);
+        d->program->setUniformValue(d->textureLocation, 0);
+
+        gl->glActiveTexture(GL_TEXTURE0);
+        gl->glBindBuffer(GL_ARRAY_BUFFER, 0);
+        gl->glEnableVertexAttribArray(VertexCoordAttribute);
+        gl->glEnableVertexAttribArray(TextureCoordAttribute);
+
+        const GLsizei stride = FloatsPerVertex * sizeof(GLfloat);
+        foreach (const Batch &batch, d->batches) {
+            gl->glBindTexture(GL_TEXTURE_2D, batch.texture);
+            gl->glVertexAttribPointer(VertexCoordAttribute, 2, GL_FLOAT, GL_FALSE, stride,
+                                      batch.vertices.constData());
+            gl->glVertexAttribPointer(TextureCoordAttribute, 2, GL_FLOAT, GL_FALSE, stride,
+                                      batch.vertices.constData() + 2);
+            gl->glDrawArrays(GL_TRIANGLES, 0, batch.vertices.size() / FloatsPerVertex);
+            ++d->drawCallCount;
+        }
+
+        gl->glDisableVertexAttribArray(VertexCoordAttribute);
+        gl->glDisableVertexAttribArray(TextureCoordAttribute);
+        gl->glBindTexture(GL_TEXTURE_2D, 0);
+        d->program->release();
+        gl->glDisable(GL_BLEND);
+    }
+
+    gl->glDisable(GL_SCISSOR_TEST);
+    d->batches.clear();
+}
+
+/*!
+    Returns how many draw calls the last call to render() issued.
+*/
+int QWaylandBatchRenderer::drawCallCount() const
+{
+    return d->drawCallCount;
+}
+
+/*!
+    Deletes all OpenGL resources of the renderer. They are created again by the
+    next call to render().
+*/
+void QWaylandBatchRenderer::releaseResources()
+{
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    if (!context) {
+        qWarning("QWaylandBatchRenderer::releaseResources() needs a current OpenGL context");
+        return;
+    }
+    QOpenGLFunctions *gl = context->functions();
+
+    for (QHash<QWaylandSurface *, SurfaceTexture>::const_iterator it = d->textures.constBegin(); it != d->textures.constEnd(); ++it) {
+        if (it->texture)
+            d->orphanedTextures << it->texture;
+    }
+    if (d->atlasTexture)
+        d->orphanedTextures << d->atlasTexture;
+    if (!d->orphanedTextures.isEmpty())
+        gl->glDeleteTextures(d->orphanedTextures.size(), d->orphanedTextures.constData());
+
+    d->orphanedTextures.clear();
+    d->textures.clear();
+    d->atlasTexture = 0;
+    d->atlasShelves.clear();
+    d->atlasShelfY = 0;
+    delete d->program;
+    d->program = Q_NULLPTR;
+}
+
+void QWaylandBatchRenderer::surfaceDamaged(const QRegion &region)
+{
+    QWaylandSurface *surface = static_cast<QWaylandSurface *>(sender());
+    QHash<QWaylandSurface *, SurfaceTexture>::iterator entry = d->textures.find(surface);
+    if (entry != d->textures.end())
+        entry->damage += region;
+}
+
+void QWaylandBatchRenderer::surfaceObjectDestroyed(QObject *object)
+{
+    // Its atlas area is reclaimed when the atlas is packed again
+    const SurfaceTexture entry = d->textures.take(static_cast<QWaylandSurface *>(object));
+    if (entry.texture)
+        d->orphanedTextures << entry.texture;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,90 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the plugins of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QWAYLANDBATCHRENDERER_H
+#define QWAYLANDBATCHRENDERER_H
+
+#include <QtCompositor/qwaylandexport.h>
+
+#ifdef QT_COMPOSITOR_WAYLAND_GL
+
+#include <QtCore/QObject>
+#include <QtGui/QColor>
+#include <QtGui/QRegion>
+
+QT_BEGIN_NAMESPACE
+
+class QWaylandOutput;
+class QWaylandSurface;
+class QWaylandSurfaceView;
+class QWaylandBatchRendererPrivate;
+
+class Q_COMPOSITOR_EXPORT QWaylandBatchRenderer : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(QColor clearColor READ clearColor WRITE setClearColor)
+public:
+    explicit QWaylandBatchRenderer(QWaylandOutput *output);
+    ~QWaylandBatchRenderer();
+
+    QWaylandOutput *output() const;
+
+    QColor clearColor() const;
+    void setClearColor(const QColor &color);
+
+    QSize atlasSize() const;
+    void setAtlasSize(const QSize &size);
+
+    QSize maxAtlasSurfaceSize() const;
+    void setMaxAtlasSurfaceSize(const QSize &size);
+
+    void render(const QList<QWaylandSurfaceView *> &views, const QRegion &damage = QRegion());
+
+    int drawCallCount() const;
+
+    void releaseResources();
+
+private Q_SLOTS:
+    void surfaceDamaged(const QRegion &region);
+    void surfaceObjectDestroyed(QObject *object);
+
+private:
+    QWaylandBatchRendererPrivate *const d;
+};
+
+QT_END_NAMESPACE
+
+#endif // QT_COMPOSITOR_WAYLAND_GL
+
+#endif
@@ -39,66 +39,61 @@
 
 QT_BEGIN_NAMESPACE
 
-class QWaylandBufferRefPrivate
-{
-public:
-    QtWayland::SurfaceBuffer *buffer;
-};
+// A QWaylandBufferRef is a single reference counted pointer, so it can be
+// created, copied and moved around on every commit without heap allocations.
+Q_STATIC_ASSERT(sizeof(QWaylandBufferRef) == sizeof(void *));
 
 QWaylandBufferRef::QWaylandBufferRef()
-                 : d(new QWaylandBufferRefPrivate)
+    : m_buffer(0)
 {
-    d->buffer = 0;
 }
 
 QWaylandBufferRef::QWaylandBufferRef(QtWayland::SurfaceBuffer *buffer)
-                 : d(new QWaylandBufferRefPrivate)
+    : m_buffer(buffer)
 {
-    d->buffer = buffer;
-    if (buffer)
-        buffer->ref();
+    if (m_buffer)
+        m_buffer->ref();
 }
 
 QWaylandBufferRef::QWaylandBufferRef(const QWaylandBufferRef &ref)
-                 : d(new QWaylandBufferRefPrivate)
+    : m_buffer(ref.m_buffer)
 {
-    d->buffer = 0;
-    *this = ref;
+    if (m_buffer)
+        m_buffer->ref();
 }
 
 QWaylandBufferRef::~QWaylandBufferRef()
 {
-    if (d->buffer)
-        d->buffer->deref();
-    delete d;
+    if (m_buffer)
+        m_buffer->deref();
 }
 
 QWaylandBufferRef &QWaylandBufferRef::operator=(const QWaylandBufferRef &ref)
 {
-    if (d->buffer)
-        d->buffer->deref();
-
-    d->buffer = ref.d->buffer;
-    if (d->buffer)
-        d->buffer->ref();
+    if (ref.m_buffer)
+        ref.m_buffer->ref();
+    if (m_buffer)
+        m_buffer->deref();
 
+    m_buffer = ref.m_buffer;
     return *this;
 }
 
 QWaylandBufferRef::operator bool() const
 {
-    return d->buffer && d->buffer->waylandBufferHandle();
+    // A released SHM buffer keeps its contents even if the client destroys it
+    return m_buffer && (m_buffer->waylandBufferHandle() || m_buffer->isReleased());
 }
 
 bool QWaylandBufferRef::isShm() const
 {
-    return d->buffer->isShmBuffer();
+    return m_buffer->isShmBuffer();
 }
 
 QImage QWaylandBufferRef::image() const
 {
-    if (d->buffer->isShmBuffer())
-        return d->buffer->image();
+    if (m_buffer->isShmBuffer())
+        return m_buffer->image();
     return QImage();
 }
 
@@ -106,22 +101,22 @@ QImage QWaylandBufferRef::image() const
 
 GLuint QWaylandBufferRef::createTexture()
 {
-    if (!d->buffer->isShmBuffer() && !d->buffer->textureCreated()) {
-        d->buffer->createTexture();
+    if (!m_buffer->isShmBuffer() && !m_buffer->textureCreated()) {
+        m_buffer->createTexture();
     }
-    return d->buffer->texture();
+    return m_buffer->texture();
 }
 
 void QWaylandBufferRef::destroyTexture()
 {
-    if (!d->buffer->isShmBuffer() && d->buffer->textureCreated()) {
-        d->buffer->destroyTexture();
+    if (!m_buffer->isShmBuffer() && m_buffer->textureCreated()) {
+        m_buffer->destroyTexture();
     }
 }
 
 void *QWaylandBufferRef::nativeBuffer() const
 {
-    return d->buffer->handle();
+    return m_buffer->handle();
 }
 #endif
 
@@ -58,6 +58,14 @@ public:
     ~QWaylandBufferRef();
 
     QWaylandBufferRef &operator=(const QWaylandBufferRef &ref);
+#ifdef Q_COMPILER_RVALUE_REFS
+    QWaylandBufferRef(QWaylandBufferRef &&other) Q_DECL_NOTHROW
+        : m_buffer(other.m_buffer) { other.m_buffer = Q_NULLPTR; }
+    QWaylandBufferRef &operator=(QWaylandBufferRef &&other) Q_DECL_NOTHROW
+    { swap(other); return *this; }
+#endif
+    void swap(QWaylandBufferRef &other) Q_DECL_NOTHROW { qSwap(m_buffer, other.m_buffer); }
+
     operator bool() const;
     bool isShm() const;
 
@@ -74,10 +82,11 @@ public:
 #endif
 
 private:
-    class QWaylandBufferRefPrivate *const d;
-    friend class QWaylandBufferRefPrivate;
+    QtWayland::SurfaceBuffer *m_buffer;
 };
 
+Q_DECLARE_SHARED(QWaylandBufferRef)
+
 QT_END_NAMESPACE
 
 #endif
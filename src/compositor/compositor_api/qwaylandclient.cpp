@@ -43,17 +43,36 @@
 #include "wayland_wrapper/qwlcompositor_p.h"
 #include "qwaylandcompositor.h"
 #include "qwaylandclient.h"
+#include "qwaylandsurface.h"
+#include "qwaylandsurfaceinterface.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QPointer>
 
 #include <wayland-server.h>
 #include <wayland-util.h>
 
+#include <sys/ioctl.h>
+
 QT_BEGIN_NAMESPACE
 
+// Bucket 0 counts pongs answered within the same millisecond, bucket n those
+// that took [2^(n-1), 2^n) ms; the last one collects everything slower
+static const int pingLatencyBucketCount = 16;
+
 class QWaylandClientPrivate : public QObjectPrivate
 {
 public:
     QWaylandClientPrivate(wl_client *_client)
         : client(_client)
+        , flushCount(0)
+        , writeCount(0)
+        , bytesWritten(0)
+        , pingPending(false)
+        , pingSerial(0)
+        , pingLatency(-1)
+        , responsive(true)
+        , pingLatencyHistogram(pingLatencyBucketCount, 0)
     {
         // Save client credentials
         wl_client_get_credentials(client, &pid, &uid, &gid);
@@ -70,6 +89,7 @@ public:
         QWaylandClient *client = reinterpret_cast<Listener *>(listener)->parent;
         Q_ASSERT(client != 0);
         QtWayland::Compositor::instance()->m_clients.removeOne(client);
+        QtWayland::Compositor::instance()->m_dirtyClients.remove(client);
         delete client;
     }
 
@@ -79,6 +99,18 @@ public:
     gid_t gid;
     pid_t pid;
 
+    quint64 flushCount;
+    quint64 writeCount;
+    quint64 bytesWritten;
+
+    bool pingPending;
+    quint32 pingSerial;
+    QElapsedTimer pingTimer;
+    QPointer<QWaylandSurface> pingSurface;
+    qint64 pingLatency;
+    bool responsive;
+    QVector<quint64> pingLatencyHistogram;
+
     struct Listener {
         wl_listener listener;
         QWaylandClient *parent;
@@ -159,6 +191,178 @@ qint64 QWaylandClient::processId() const
     return d->pid;
 }
 
+/*!
+    Returns how many times the compositor flushed this client on its own,
+    after events were queued for it outside of request dispatch. This counts
+    calls, not syscalls: a flush with nothing queued does not write anything.
+    The flushes of all clients at once after dispatching requests are not
+    included.
+*/
+quint64 QWaylandClient::flushCount() const
+{
+    Q_D(const QWaylandClient);
+
+    return d->flushCount;
+}
+
+/*!
+    Returns an estimate of how many of the flushes counted by flushCount()
+    actually wrote to the client socket.
+
+    wl_client_flush() does not report what it wrote, so this is derived from
+    the growth of the socket send queue, which misses writes if the client
+    read in between. Only collected when the QT_WAYLAND_FLUSH_STATISTICS
+    environment variable is set, as it costs two extra ioctl() calls per flush.
+*/
+quint64 QWaylandClient::writeCount() const
+{
+    Q_D(const QWaylandClient);
+
+    return d->writeCount;
+}
+
+/*!
+    Returns an estimate of the number of bytes written to the client socket
+    by the flushes counted by flushCount(), derived the same way as
+    writeCount().
+
+    Only collected when the QT_WAYLAND_FLUSH_STATISTICS environment variable
+    is set.
+*/
+quint64 QWaylandClient::bytesWritten() const
+{
+    Q_D(const QWaylandClient);
+
+    return d->bytesWritten;
+}
+
+/*!
+    Returns false if the client did not answer a liveness ping within the
+    compositor's unresponsive timeout, true otherwise. The client becomes
+    responsive again as soon as the pong arrives.
+
+    \sa QWaylandCompositor::setPingInterval()
+*/
+bool QWaylandClient::isResponsive() const
+{
+    Q_D(const QWaylandClient);
+
+    return d->responsive;
+}
+
+/*!
+    Returns the time in milliseconds it took the client to answer the last
+    liveness ping, or -1 if it has not answered one yet.
+*/
+qint64 QWaylandClient::pingLatency() const
+{
+    Q_D(const QWaylandClient);
+
+    return d->pingLatency;
+}
+
+/*!
+    Returns the distribution of the liveness ping latencies of this client.
+    Entry 0 counts the pongs received within a millisecond, entry n the ones
+    that took from 2^(n-1) up to 2^n milliseconds. The last entry counts all
+    slower pongs.
+*/
+QVector<quint64> QWaylandClient::pingLatencyHistogram() const
+{
+    Q_D(const QWaylandClient);
+
+    return d->pingLatencyHistogram;
+}
+
+bool QWaylandClient::ping(QWaylandSurface *surface)
+{
+    Q_D(QWaylandClient);
+
+    // Only one ping is in flight per client
+    if (d->pingPending)
+        return true;
+
+    quint32 serial = wl_display_next_serial(QtWayland::Compositor::instance()->wl_display());
+    QWaylandSurfacePingOp op(serial);
+    if (!surface->sendInterfaceOp(op))
+        return false;
+
+    d->pingPending = true;
+    d->pingSerial = serial;
+    d->pingSurface = surface;
+    d->pingTimer.start();
+    return true;
+}
+
+bool QWaylandClient::pong(quint32 serial)
+{
+    Q_D(QWaylandClient);
+
+    if (!d->pingPending || serial != d->pingSerial)
+        return false;
+
+    d->pingPending = false;
+    d->pingSurface.clear();
+    d->pingLatency = d->pingTimer.elapsed();
+
+    int bucket = 0;
+    for (qint64 latency = d->pingLatency; latency > 0 && bucket < pingLatencyBucketCount - 1; latency >>= 1)
+        ++bucket;
+    ++d->pingLatencyHistogram[bucket];
+
+    if (!d->responsive) {
+        d->responsive = true;
+        emit responsiveChanged(true);
+    }
+    return true;
+}
+
+void QWaylandClient::checkResponsive(int timeout)
+{
+    Q_D(QWaylandClient);
+
+    if (!d->pingPending)
+        return;
+
+    // The pong for a surface destroyed meanwhile never arrives
+    if (!d->pingSurface) {
+        d->pingPending = false;
+        return;
+    }
+
+    if (d->responsive && d->pingTimer.elapsed() > timeout) {
+        d->responsive = false;
+        emit responsiveChanged(false);
+    }
+}
+
+void QWaylandClient::flush()
+{
+    Q_D(QWaylandClient);
+
+    static bool collectStatistics = qEnvironmentVariableIsSet("QT_WAYLAND_FLUSH_STATISTICS");
+
+    ++d->flushCount;
+    if (!collectStatistics) {
+        wl_client_flush(d->client);
+        return;
+    }
+
+    // The growth of the unread data in the socket is what this flush wrote,
+    // provided the client did not read in between the two calls
+    int fd = wl_client_get_fd(d->client);
+    int queuedBefore = 0;
+    int queuedAfter = 0;
+    ioctl(fd, TIOCOUTQ, &queuedBefore);
+    wl_client_flush(d->client);
+    ioctl(fd, TIOCOUTQ, &queuedAfter);
+
+    if (queuedAfter > queuedBefore) {
+        ++d->writeCount;
+        d->bytesWritten += queuedAfter - queuedBefore;
+    }
+}
+
 void QWaylandClient::kill(int sig)
 {
     Q_D(QWaylandClient);
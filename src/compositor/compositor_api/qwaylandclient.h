@@ -44,6 +44,7 @@
 #include <QtCompositor/qwaylandexport.h>
 
 #include <QObject>
+#include <QVector>
 
 #include <signal.h>
 
@@ -52,6 +53,11 @@ struct wl_client;
 QT_BEGIN_NAMESPACE
 
 class QWaylandClientPrivate;
+class QWaylandSurface;
+
+namespace QtWayland {
+    class Compositor;
+}
 
 class Q_COMPOSITOR_EXPORT QWaylandClient : public QObject
 {
@@ -61,6 +67,11 @@ class Q_COMPOSITOR_EXPORT QWaylandClient : public QObject
     Q_PROPERTY(qint64 userId READ userId CONSTANT)
     Q_PROPERTY(qint64 groupId READ groupId CONSTANT)
     Q_PROPERTY(qint64 processId READ processId CONSTANT)
+    Q_PROPERTY(quint64 flushCount READ flushCount)
+    Q_PROPERTY(quint64 writeCount READ writeCount)
+    Q_PROPERTY(quint64 bytesWritten READ bytesWritten)
+    Q_PROPERTY(bool responsive READ isResponsive NOTIFY responsiveChanged)
+    Q_PROPERTY(qint64 pingLatency READ pingLatency)
 public:
     ~QWaylandClient();
 
@@ -73,13 +84,31 @@ public:
 
     qint64 processId() const;
 
+    quint64 flushCount() const;
+    quint64 writeCount() const;
+    quint64 bytesWritten() const;
+
+    bool isResponsive() const;
+    qint64 pingLatency() const;
+    QVector<quint64> pingLatencyHistogram() const;
+
     Q_INVOKABLE void kill(int sig = SIGTERM);
 
 public Q_SLOTS:
     void close();
 
+Q_SIGNALS:
+    void responsiveChanged(bool responsive);
+
 private:
     explicit QWaylandClient(wl_client *client);
+
+    void flush();
+    bool ping(QWaylandSurface *surface);
+    bool pong(quint32 serial);
+    void checkResponsive(int timeout);
+
+    friend class QtWayland::Compositor;
 };
 
 QT_END_NAMESPACE
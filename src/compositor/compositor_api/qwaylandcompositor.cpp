@@ -185,7 +185,7 @@ QWaylandSurfaceView *QWaylandCompositor::pickView(const QPointF &globalPosition)
 
         Q_FOREACH (QWaylandSurface *surface, output->surfaces()) {
             Q_FOREACH (QWaylandSurfaceView *view, surface->views()) {
-                if (QRectF(view->pos(), surface->size()).contains(globalPosition))
+                if (surface->inputRegionContains(globalPosition - view->pos()))
                     return view;
             }
         }
@@ -225,6 +225,84 @@ bool QWaylandCompositor::retainedSelectionEnabled() const
     return m_compositor->retainedSelectionEnabled();
 }
 
+/*!
+    Enables releasing SHM buffers back to their clients as soon as they are
+    committed. The committed contents are copied into a copy kept by the
+    surface, updating only the damaged parts, and QWaylandBufferRef::image()
+    returns that copy. Clients can then reuse their buffers right away and
+    render double-buffered.
+
+    This is disabled by default.
+*/
+void QWaylandCompositor::setEarlyShmBufferReleaseEnabled(bool enabled)
+{
+    m_compositor->setEarlyShmBufferReleaseEnabled(enabled);
+}
+
+bool QWaylandCompositor::earlyShmBufferReleaseEnabled() const
+{
+    return m_compositor->earlyShmBufferReleaseEnabled();
+}
+
+/*!
+    Makes the compositor ping every client with a mapped surface each \a msecs
+    milliseconds, to measure how fast the clients answer and to detect hung
+    ones. A client has at most one ping in flight.
+
+    Setting 0 disables the pings, which is the default.
+
+    \sa QWaylandClient::isResponsive(), QWaylandClient::pingLatencyHistogram()
+*/
+void QWaylandCompositor::setPingInterval(int msecs)
+{
+    m_compositor->setPingInterval(msecs);
+}
+
+int QWaylandCompositor::pingInterval() const
+{
+    return m_compositor->pingInterval();
+}
+
+/*!
+    Sets how many milliseconds a client may take to answer a ping before it
+    is reported as unresponsive. The check runs with the pings, so a hang is
+    noticed at most one ping interval late.
+
+    The default is 5000.
+*/
+void QWaylandCompositor::setUnresponsiveTimeout(int msecs)
+{
+    m_compositor->setUnresponsiveTimeout(msecs);
+}
+
+int QWaylandCompositor::unresponsiveTimeout() const
+{
+    return m_compositor->unresponsiveTimeout();
+}
+
+/*!
+    Makes inputDeviceFor() remember which input device owns the touch events
+    of each QTouchDevice, instead of asking every device with
+    QWaylandInputDevice::isOwner() for every touch event. Key and mouse events
+    do not say which device they come from and are always routed by asking.
+
+    Only enable this when isOwner() answers the same for all the events of a
+    QTouchDevice. The cache is keyed on the QTouchDevice address, so disable
+    and enable it again after a touch device was removed, to drop its route.
+    Registering or removing an input device drops the routes as well.
+
+    This is disabled by default.
+*/
+void QWaylandCompositor::setTouchRouteCacheEnabled(bool enabled)
+{
+    m_compositor->setTouchRouteCacheEnabled(enabled);
+}
+
+bool QWaylandCompositor::touchRouteCacheEnabled() const
+{
+    return m_compositor->touchRouteCacheEnabled();
+}
+
 void QWaylandCompositor::retainedSelectionReceived(QMimeData *)
 {
 }
@@ -340,9 +418,8 @@ void QWaylandCompositor::sendDragEndEvent()
 
 void QWaylandCompositor::setCursorSurface(QWaylandSurface *surface, int hotspotX, int hotspotY)
 {
-    Q_UNUSED(surface);
-    Q_UNUSED(hotspotX);
-    Q_UNUSED(hotspotY);
+    Q_FOREACH (QWaylandOutput *output, outputs())
+        output->setCursorSurface(surface, QPoint(hotspotX, hotspotY));
 }
 
 void QWaylandCompositor::configureTouchExtension(TouchExtensionFlags flags)
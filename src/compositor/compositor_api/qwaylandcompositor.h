@@ -120,6 +120,14 @@ public:
 
     void setRetainedSelectionEnabled(bool enabled);
     bool retainedSelectionEnabled() const;
+    void setEarlyShmBufferReleaseEnabled(bool enabled);
+    bool earlyShmBufferReleaseEnabled() const;
+    void setPingInterval(int msecs);
+    int pingInterval() const;
+    void setUnresponsiveTimeout(int msecs);
+    int unresponsiveTimeout() const;
+    void setTouchRouteCacheEnabled(bool enabled);
+    bool touchRouteCacheEnabled() const;
     void overrideSelection(const QMimeData *data);
 
     void setClientFullScreenHint(bool value);
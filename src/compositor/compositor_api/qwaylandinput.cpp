@@ -101,11 +101,20 @@ void QWaylandInputDevice::sendMouseWheelEvent(Qt::Orientation orientation, int d
 void QWaylandInputDevice::sendKeyPressEvent(uint code)
 {
     d->keyboardDevice()->sendKeyPressEvent(code);
+    d->scheduleFlush();
 }
 
 void QWaylandInputDevice::sendKeyReleaseEvent(uint code)
 {
     d->keyboardDevice()->sendKeyReleaseEvent(code);
+    d->scheduleFlush();
+}
+
+uint QWaylandInputDevice::keyCodeForQtKey(int key, Qt::KeyboardModifiers modifiers) const
+{
+    if (!d->keyboardDevice())
+        return 0;
+    return d->keyboardDevice()->keycodeForQtKey(key, modifiers);
 }
 
 void QWaylandInputDevice::sendTouchPointEvent(int id, double x, double y, Qt::TouchPointState state)
@@ -183,6 +192,10 @@ QWaylandInputDevice::CapabilityFlags QWaylandInputDevice::capabilities()
     return d->capabilities();
 }
 
+/** Returns true if \a inputEvent comes from this device. The default claims every event.
+ *  With QWaylandCompositor::setTouchRouteCacheEnabled() this is only asked for the first
+ *  touch event of each QTouchDevice, so the answer must then hold for the whole device.
+ **/
 bool QWaylandInputDevice::isOwner(QInputEvent *inputEvent)
 {
     Q_UNUSED(inputEvent);
@@ -104,6 +104,7 @@ public:
 
     void sendKeyPressEvent(uint code);
     void sendKeyReleaseEvent(uint code);
+    uint keyCodeForQtKey(int key, Qt::KeyboardModifiers modifiers = Qt::NoModifier) const;
 
     void sendFullKeyEvent(QKeyEvent *event);
     void sendFullKeyEvent(QWaylandSurface *surface, QKeyEvent *event);
@@ -47,8 +47,10 @@
 
 #include "wayland_wrapper/qwlcompositor_p.h"
 #include "wayland_wrapper/qwloutput_p.h"
+#include "wayland_wrapper/qwlsurface_p.h"
 #include "qwaylandcompositor.h"
 #include "qwaylandoutput.h"
+#include "qwaylandoutputcapture.h"
 #include "qwaylandsurface.h"
 
 QWaylandOutput::QWaylandOutput(QWaylandCompositor *compositor, QWindow *window,
@@ -84,6 +86,9 @@ QWaylandOutput *QWaylandOutput::fromResource(wl_resource *resource)
 
 void QWaylandOutput::update()
 {
+    if (!window())
+        return;
+
     QRect rect(QPoint(0, 0), window()->size());
     QRegion region(rect);
     QExposeEvent *event = new QExposeEvent(region);
@@ -255,3 +260,112 @@ QList<QWaylandSurface *> QWaylandOutput::surfaces() const
     }
     return list;
 }
+
+/*!
+    Returns the surface shown as the cursor on this output, or null if the
+    cursor is hidden.
+*/
+QWaylandSurface *QWaylandOutput::cursorSurface() const
+{
+    return d_ptr->m_cursorSurface;
+}
+
+QPoint QWaylandOutput::cursorHotspot() const
+{
+    return d_ptr->m_cursorHotspot;
+}
+
+/*!
+    Shows \a surface as the cursor, with \a hotspot placed at the cursor position.
+    The cursor is kept apart from the scene: moving it or updating its buffer
+    only emits cursorChanged() with the few pixels it covered and now covers,
+    so backends can recomposite that area instead of the whole output.
+    Pass a null surface to hide the cursor.
+*/
+void QWaylandOutput::setCursorSurface(QWaylandSurface *surface, const QPoint &hotspot)
+{
+    if (d_ptr->m_cursorSurface == surface && d_ptr->m_cursorHotspot == hotspot)
+        return;
+
+    if (d_ptr->m_cursorSurface != surface) {
+        if (d_ptr->m_cursorSurface)
+            disconnect(d_ptr->m_cursorSurface, 0, this, 0);
+        d_ptr->m_cursorSurface = surface;
+        if (surface) {
+            // Keep it out of the scene, it is composited as the cursor layer
+            surface->handle()->setCursorSurface(true);
+            connect(surface, &QWaylandSurface::damaged, this, &QWaylandOutput::cursorSurfaceDamaged);
+            connect(surface, &QObject::destroyed, this, &QWaylandOutput::cursorSurfaceDestroyed);
+        }
+    }
+    d_ptr->m_cursorHotspot = hotspot;
+    updateCursorGeometry();
+}
+
+QPoint QWaylandOutput::cursorPosition() const
+{
+    return d_ptr->m_cursorPosition;
+}
+
+/*!
+    Moves the cursor to \a position, in compositor coordinates. Pointer motion
+    sent through QWaylandInputDevice moves the cursor of every output already.
+*/
+void QWaylandOutput::setCursorPosition(const QPoint &position)
+{
+    if (d_ptr->m_cursorPosition == position)
+        return;
+
+    d_ptr->m_cursorPosition = position;
+    updateCursorGeometry();
+}
+
+/*!
+    Returns the area covered by the cursor, relative to the output.
+*/
+QRect QWaylandOutput::cursorGeometry() const
+{
+    return d_ptr->m_cursorRect;
+}
+
+void QWaylandOutput::updateCursorGeometry()
+{
+    QRect rect;
+    if (d_ptr->m_cursorSurface) {
+        rect = QRect(d_ptr->m_cursorPosition - d_ptr->m_cursorHotspot - d_ptr->position(),
+                     d_ptr->m_cursorSurface->size());
+    }
+
+    if (rect == d_ptr->m_cursorRect)
+        return;
+
+    const QRegion damage = QRegion(d_ptr->m_cursorRect) + rect;
+    d_ptr->m_cursorRect = rect;
+    Q_EMIT cursorChanged(damage);
+}
+
+void QWaylandOutput::cursorSurfaceDamaged()
+{
+    // A new cursor buffer may also come with a new size
+    const QRect previous = d_ptr->m_cursorRect;
+    d_ptr->m_cursorRect = QRect(d_ptr->m_cursorPosition - d_ptr->m_cursorHotspot - d_ptr->position(),
+                                d_ptr->m_cursorSurface->size());
+    Q_EMIT cursorChanged(QRegion(previous) + d_ptr->m_cursorRect);
+}
+
+void QWaylandOutput::cursorSurfaceDestroyed()
+{
+    d_ptr->m_cursorSurface = Q_NULLPTR;
+    updateCursorGeometry();
+}
+
+/*!
+    Hands a composited frame to the captures attached to this output. Backends
+    that render into memory call this after every frame with the region of
+    \a framebuffer that changed, which may be empty.
+*/
+void QWaylandOutput::updateCaptures(const QImage &framebuffer, const QRegion &damage)
+{
+    Q_FOREACH (QWaylandOutputCapture *capture, d_ptr->captures())
+        capture->frameComposited(framebuffer, damage);
+}
@@ -45,6 +45,8 @@
 #include <QtCompositor/qwaylandexport.h>
 
 #include <QObject>
+#include <QImage>
+#include <QRegion>
 #include <QRect>
 #include <QSize>
 
@@ -56,6 +58,7 @@ class QWaylandCompositor;
 class QWindow;
 class QWaylandSurface;
 class QWaylandClient;
+class QWaylandOutputCapture;
 
 namespace QtWayland {
     class Output;
@@ -147,6 +150,15 @@ public:
 
     QList<QWaylandSurface *> surfaces() const;
 
+    QWaylandSurface *cursorSurface() const;
+    QPoint cursorHotspot() const;
+    void setCursorSurface(QWaylandSurface *surface, const QPoint &hotspot);
+
+    QPoint cursorPosition() const;
+    void setCursorPosition(const QPoint &position);
+
+    QRect cursorGeometry() const;
+
 Q_SIGNALS:
     void positionChanged();
     void geometryChanged();
@@ -156,8 +168,20 @@ Q_SIGNALS:
     void scaleFactorChanged();
     void subpixelChanged();
     void transformChanged();
+    void cursorChanged(const QRegion &damage);
+    void surfaceEntered(QWaylandSurface *surface);
+    void surfaceLeft(QWaylandSurface *surface);
+
+protected:
+    void updateCaptures(const QImage &framebuffer, const QRegion &damage);
+
+private Q_SLOTS:
+    void cursorSurfaceDamaged();
+    void cursorSurfaceDestroyed();
 
 private:
+    void updateCursorGeometry();
+
     QtWayland::Output *const d_ptr;
 };
 
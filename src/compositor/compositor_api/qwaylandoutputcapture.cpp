@@ -0,0 +1,291 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the plugins of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qwaylandoutputcapture.h"
+
+#include "qwaylandoutput.h"
+
+#include "wayland_wrapper/qwloutput_p.h"
+
+#include <QtCore/QPointer>
+#include <QtGui/QPainter>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QWaylandOutputCapture
+    \brief Incrementally reads back the composited contents of an output.
+
+    A capture owns a single destination buffer, either provided by the caller
+    or allocated in anonymous shared memory so it can be handed to another
+    process. Every composited frame only copies the rectangles that changed
+    since the previous delivered frame and frameReady() reports them.
+
+    The buffer belongs to the consumer between frameReady() and release().
+    Frames composited in the meantime are not copied; their damage is merged
+    into the next delivered frame, so a slow consumer drops frames instead of
+    stalling the compositor.
+
+    Only outputs that expose their framebuffer, such as QWaylandSoftwareOutput,
+    feed captures.
+*/
+
+class QWaylandOutputCapturePrivate
+{
+public:
+    QWaylandOutputCapturePrivate()
+        : bits(0)
+        , bytesPerLine(0)
+        , fd(-1)
+        , mappedSize(0)
+        , busy(false)
+        , droppedFrames(0)
+    {
+    }
+
+    void freeSharedBuffer()
+    {
+        if (fd < 0)
+            return;
+        munmap(bits, mappedSize);
+        close(fd);
+        fd = -1;
+        mappedSize = 0;
+    }
+
+    QPointer<QWaylandOutput> output;
+    uchar *bits;
+    QSize size;
+    int bytesPerLine;
+    int fd;
+    size_t mappedSize;
+    QRegion pendingDamage;
+    bool busy;
+    int droppedFrames;
+};
+
+QWaylandOutputCapture::QWaylandOutputCapture(QWaylandOutput *output, QObject *parent)
+    : QObject(parent)
+    , d(new QWaylandOutputCapturePrivate)
+{
+    d->output = output;
+    output->handle()->addCapture(this);
+}
+
+QWaylandOutputCapture::~QWaylandOutputCapture()
+{
+    if (d->output)
+        d->output->handle()->removeCapture(this);
+    d->freeSharedBuffer();
+    delete d;
+}
+
+QWaylandOutput *QWaylandOutputCapture::output() const
+{
+    return d->output;
+}
+
+/*!
+    Uses the caller owned memory at \a data as destination. It must hold \a size
+    pixels in QImage::Format_ARGB32_Premultiplied and stay valid for the lifetime
+    of the capture. The next frame delivers the whole buffer.
+*/
+bool QWaylandOutputCapture::setBuffer(uchar *data, const QSize &size, int bytesPerLine)
+{
+    if (!data || size.isEmpty() || bytesPerLine < size.width() * 4)
+        return false;
+
+    d->freeSharedBuffer();
+    d->bits = data;
+    d->size = size;
+    d->bytesPerLine = bytesPerLine;
+    d->pendingDamage = QRect(QPoint(), size);
+    d->busy = false;
+    if (d->output)
+        d->output->update();
+    return true;
+}
+
+/*!
+    Allocates a destination buffer of \a size pixels in anonymous shared memory.
+    The file descriptor is available from sharedBufferFd().
+*/
+bool QWaylandOutputCapture::allocateSharedBuffer(const QSize &size)
+{
+    if (size.isEmpty())
+        return false;
+
+    const int stride = size.width() * 4;
+    const size_t alloc = size_t(stride) * size.height();
+
+    int fd = -1;
+#ifdef SYS_memfd_create
+    fd = syscall(SYS_memfd_create, "qwaylandoutputcapture", MFD_CLOEXEC);
+#endif
+    if (fd < 0) {
+        char filename[] = "/tmp/wayland-capture-XXXXXX";
+        fd = mkstemp(filename);
+        if (fd < 0) {
+            qWarning("mkstemp %s failed: %s", filename, strerror(errno));
+            return false;
+        }
+        unlink(filename);
+        int flags = fcntl(fd, F_GETFD);
+        if (flags != -1)
+            fcntl(fd, F_SETFD, flags | FD_CLOEXEC);
+    }
+
+    if (ftruncate(fd, alloc) < 0) {
+        qWarning("ftruncate failed: %s", strerror(errno));
+        close(fd);
+        return false;
+    }
+
+    void *data = mmap(NULL, alloc, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+        qWarning("mmap failed: %s", strerror(errno));
+        close(fd);
+        return false;
+    }
+
+    setBuffer(static_cast<uchar *>(data), size, stride);
+    d->fd = fd;
+    d->mappedSize = alloc;
+    return true;
+}
+
+/*!
+    Returns the file descriptor of the buffer allocated by allocateSharedBuffer(),
+    or -1 when the capture uses caller provided memory. The capture keeps ownership.
+*/
+int QWaylandOutputCapture::sharedBufferFd() const
+{
+    return d->fd;
+}
+
+/*!
+    Returns a read-only image wrapping the destination buffer.
+*/
+QImage QWaylandOutputCapture::image() const
+{
+    if (!d->bits)
+        return QImage();
+    return QImage(const_cast<const uchar *>(d->bits), d->size.width(), d->size.height(),
+                  d->bytesPerLine, QImage::Format_ARGB32_Premultiplied);
+}
+
+/*!
+    Returns true while the consumer owns the buffer, that is between
+    frameReady() and release().
+*/
+bool QWaylandOutputCapture::isBusy() const
+{
+    return d->busy;
+}
+
+/*!
+    Returns the number of composited frames that were skipped because
+    the consumer had not released the previous one yet.
+*/
+int QWaylandOutputCapture::droppedFrames() const
+{
+    return d->droppedFrames;
+}
+
+/*!
+    Hands the buffer back to the capture. Damage accumulated while the
+    consumer was busy is delivered with the next frame.
+*/
+void QWaylandOutputCapture::release()
+{
+    if (!d->busy)
+        return;
+
+    d->busy = false;
+    if (!d->pendingDamage.isEmpty() && d->output)
+        d->output->update();
+}
+
+void QWaylandOutputCapture::frameComposited(const QImage &framebuffer, const QRegion &damage)
+{
+    if (!d->bits)
+        return;
+
+    d->pendingDamage += damage;
+    if (d->busy) {
+        if (!damage.isEmpty())
+            ++d->droppedFrames;
+        return;
+    }
+
+    const QRegion region = d->pendingDamage & QRect(QPoint(), d->size) & framebuffer.rect();
+    if (region.isEmpty())
+        return;
+    d->pendingDamage = QRegion();
+
+    if (framebuffer.format() == QImage::Format_ARGB32_Premultiplied) {
+        const uchar *src = framebuffer.constBits();
+        const int srcBytesPerLine = framebuffer.bytesPerLine();
+        foreach (const QRect &rect, region.rects()) {
+            for (int y = rect.top(); y <= rect.bottom(); ++y) {
+                memcpy(d->bits + y * d->bytesPerLine + rect.x() * 4,
+                       src + y * srcBytesPerLine + rect.x() * 4,
+                       rect.width() * 4);
+            }
+        }
+    } else {
+        QImage target(d->bits, d->size.width(), d->size.height(), d->bytesPerLine,
+                      QImage::Format_ARGB32_Premultiplied);
+        QPainter painter(&target);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        painter.setClipRegion(region);
+        painter.drawImage(0, 0, framebuffer);
+    }
+
+    d->busy = true;
+    Q_EMIT frameReady(region);
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,274 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the plugins of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qwaylandoutputdamage.h"
+
+#include "qwaylandoutput.h"
+#include "qwaylandsurface.h"
+#include "qwaylandsurfaceview.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QSet>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QWaylandOutputDamage
+    \brief Accumulates the parts of an output that need to be repainted.
+
+    QWaylandOutputDamage merges the damage committed by the surfaces shown on
+    an output, translated to their view positions, with the areas uncovered or
+    covered by views being mapped, unmapped or moved. All regions are in
+    output coordinates.
+
+    A renderer passes the views it is about to draw to setViews(), repaints
+    damageSince() the age of its back buffer and calls endFrame() after the
+    swap. Renderers that keep a single framebuffer use a buffer age of 1.
+*/
+
+class QWaylandOutputDamagePrivate
+{
+public:
+    QWaylandOutputDamagePrivate(QWaylandOutput *o)
+        : output(o)
+        , maxBufferAge(4)
+    {
+    }
+
+    QRect bounds() const { return QRect(QPoint(), output->geometry().size()); }
+
+    QWaylandOutput *output;
+    int maxBufferAge;
+
+    QRegion pending;
+    // Damage of the previous frames, most recent first
+    QList<QRegion> history;
+
+    struct ViewGeometry
+    {
+        QRect rect;
+        QObject *surface;
+    };
+
+    QHash<QWaylandSurfaceView *, ViewGeometry> viewGeometry;
+    QSet<QObject *> trackedSurfaces;
+};
+
+QWaylandOutputDamage::QWaylandOutputDamage(QWaylandOutput *output)
+    : QObject(output)
+    , d(new QWaylandOutputDamagePrivate(output))
+{
+    // Any change to the output placement shifts or resizes everything shown
+    connect(output, &QWaylandOutput::geometryChanged, this, &QWaylandOutputDamage::invalidate);
+    connect(output, &QWaylandOutput::modeChanged, this, &QWaylandOutputDamage::invalidate);
+    connect(output, &QWaylandOutput::positionChanged, this, &QWaylandOutputDamage::invalidate);
+    invalidate();
+}
+
+QWaylandOutputDamage::~QWaylandOutputDamage()
+{
+    delete d;
+}
+
+QWaylandOutput *QWaylandOutputDamage::output() const
+{
+    return d->output;
+}
+
+/*!
+    Returns how many frames back the damage is remembered. Buffers older than
+    that are repainted completely. The default is 4.
+*/
+int QWaylandOutputDamage::maxBufferAge() const
+{
+    return d->maxBufferAge;
+}
+
+void QWaylandOutputDamage::setMaxBufferAge(int age)
+{
+    d->maxBufferAge = qMax(1, age);
+    while (d->history.size() > d->maxBufferAge - 1)
+        d->history.removeLast();
+}
+
+/*!
+    Sets the views that are shown in the coming frame. Views that appeared,
+    disappeared, moved or changed size since the previous call damage both
+    their old and their new geometry.
+*/
+void QWaylandOutputDamage::setViews(const QList<QWaylandSurfaceView *> &views)
+{
+    const QPoint origin = d->output->position();
+    QRegion damage;
+    QHash<QWaylandSurfaceView *, QWaylandOutputDamagePrivate::ViewGeometry> viewGeometry;
+
+    Q_FOREACH (QWaylandSurfaceView *view, views) {
+        QWaylandSurface *surface = view->surface();
+        if (!d->trackedSurfaces.contains(surface)) {
+            connect(surface, &QWaylandSurface::damaged, this, &QWaylandOutputDamage::surfaceDamaged);
+            connect(surface, &QWaylandSurface::viewRemoved, this, &QWaylandOutputDamage::viewRemoved);
+            connect(surface, &QObject::destroyed, this, &QWaylandOutputDamage::surfaceObjectDestroyed);
+            d->trackedSurfaces.insert(surface);
+        }
+
+        const QWaylandOutputDamagePrivate::ViewGeometry geometry = {
+            QRect(view->pos().toPoint() - origin, surface->size()), surface
+        };
+        QHash<QWaylandSurfaceView *, QWaylandOutputDamagePrivate::ViewGeometry>::iterator previous =
+                d->viewGeometry.find(view);
+        if (previous == d->viewGeometry.end()) {
+            damage += geometry.rect;
+        } else {
+            if (previous.value().rect != geometry.rect)
+                damage += QRegion(previous.value().rect) + geometry.rect;
+            d->viewGeometry.erase(previous);
+        }
+        viewGeometry.insert(view, geometry);
+    }
+
+    // Whatever is left was shown before but is gone now
+    Q_FOREACH (const QWaylandOutputDamagePrivate::ViewGeometry &geometry, d->viewGeometry)
+        damage += geometry.rect;
+    d->viewGeometry = viewGeometry;
+
+    addDamage(damage);
+}
+
+/*!
+    Adds \a region, in output coordinates, to the damage of the coming frame.
+*/
+void QWaylandOutputDamage::addDamage(const QRegion &region)
+{
+    const QRegion damage = region & d->bounds();
+    if (damage.isEmpty())
+        return;
+
+    d->pending += damage;
+    Q_EMIT damaged(damage);
+}
+
+/*!
+    Damages the whole output, for instance after a change that affects every
+    pixel such as a new background.
+*/
+void QWaylandOutputDamage::invalidate()
+{
+    addDamage(d->bounds());
+}
+
+/*!
+    Returns the damage of the coming frame.
+*/
+QRegion QWaylandOutputDamage::damage() const
+{
+    return d->pending;
+}
+
+/*!
+    Returns the region to repaint in a back buffer that holds the contents
+    of \a bufferAge frames ago, as reported by EGL_EXT_buffer_age. An age of 0
+    means the contents are undefined, as does an age beyond maxBufferAge(); the
+    whole output is returned then.
+*/
+QRegion QWaylandOutputDamage::damageSince(int bufferAge) const
+{
+    if (bufferAge <= 0 || bufferAge > d->history.size() + 1)
+        return d->bounds();
+
+    QRegion damage = d->pending;
+    for (int i = 0; i < bufferAge - 1; ++i)
+        damage += d->history.at(i);
+    return damage;
+}
+
+/*!
+    Marks the coming frame as presented. Its damage is remembered for
+    damageSince() and the damage of the next frame starts out empty.
+*/
+void QWaylandOutputDamage::endFrame()
+{
+    if (d->maxBufferAge > 1) {
+        d->history.prepend(d->pending);
+        if (d->history.size() > d->maxBufferAge - 1)
+            d->history.removeLast();
+    }
+    d->pending = QRegion();
+}
+
+void QWaylandOutputDamage::surfaceDamaged(const QRegion &region)
+{
+    QWaylandSurface *surface = static_cast<QWaylandSurface *>(sender());
+    QRegion damage;
+    Q_FOREACH (QWaylandSurfaceView *view, surface->views()) {
+        QHash<QWaylandSurfaceView *, QWaylandOutputDamagePrivate::ViewGeometry>::const_iterator geometry =
+                d->viewGeometry.constFind(view);
+        if (geometry != d->viewGeometry.constEnd())
+            damage += region.translated(geometry.value().rect.topLeft());
+    }
+    addDamage(damage);
+}
+
+void QWaylandOutputDamage::surfaceObjectDestroyed(QObject *object)
+{
+    d->trackedSurfaces.remove(object);
+
+    // Views are normally gone before their surface, but do not keep any
+    // that were not
+    QRegion damage;
+    QHash<QWaylandSurfaceView *, QWaylandOutputDamagePrivate::ViewGeometry>::iterator it = d->viewGeometry.begin();
+    while (it != d->viewGeometry.end()) {
+        if (it.value().surface == object) {
+            damage += it.value().rect;
+            it = d->viewGeometry.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    addDamage(damage);
+}
+
+// A destroyed view uncovers what it showed, and its address may be reused
+// by a new view
+void QWaylandOutputDamage::viewRemoved(QWaylandSurfaceView *view)
+{
+    QHash<QWaylandSurfaceView *, QWaylandOutputDamagePrivate::ViewGeometry>::iterator geometry =
+            d->viewGeometry.find(view);
+    if (geometry == d->viewGeometry.end())
+        return;
+
+    addDamage(geometry.value().rect);
+    d->viewGeometry.erase(geometry);
+}
+
+QT_END_NAMESPACE
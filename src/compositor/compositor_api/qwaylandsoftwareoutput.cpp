@@ -0,0 +1,357 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the plugins of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qwaylandsoftwareoutput.h"
+
+#include "qwaylandbufferref.h"
+#include "qwaylandcompositor.h"
+#include "qwaylandoutputdamage.h"
+#include "qwaylandsurface.h"
+#include "qwaylandsurfaceview.h"
+
+#include "wayland_wrapper/qwlsurface_p.h"
+
+#include <QtCore/QRunnable>
+#include <QtCore/QSet>
+#include <QtCore/QThreadPool>
+#include <QtCore/QTimer>
+#include <QtGui/QPainter>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QWaylandSoftwareOutput
+    \brief An output that composites SHM surfaces into an offscreen QImage.
+
+    QWaylandSoftwareOutput does not need a window or an OpenGL context. Every
+    refresh interval it repaints the parts of its framebuffer that changed since
+    the previous frame and sends the frame callbacks of the surfaces it shows.
+    Only SHM buffers can be composited; surfaces using other buffer types are
+    skipped.
+
+    The cursor set with setCursorSurface() is drawn on top of the scene. Moving
+    it only repaints the area it left and the area it enters.
+*/
+
+static const int tileHeight = 64;
+
+struct SoftwareLayer
+{
+    QImage image;
+    QPoint position;
+};
+
+class SoftwareTileJob : public QRunnable
+{
+public:
+    SoftwareTileJob(uchar *bits, int bytesPerLine, const QRect &tile, const QRegion &damage,
+                    const QVector<SoftwareLayer> &layers, const QColor &clearColor)
+        : m_bits(bits)
+        , m_bytesPerLine(bytesPerLine)
+        , m_tile(tile)
+        , m_damage(damage)
+        , m_layers(layers)
+        , m_clearColor(clearColor)
+    {
+    }
+
+    void run() Q_DECL_OVERRIDE
+    {
+        // Each tile is a band of whole scanlines, so the painters of different
+        // tiles never share memory and can run concurrently.
+        QImage band(m_bits + m_tile.y() * m_bytesPerLine, m_tile.width(), m_tile.height(),
+                    m_bytesPerLine, QImage::Format_ARGB32_Premultiplied);
+        QPainter painter(&band);
+        painter.translate(0, -m_tile.y());
+        painter.setClipRegion(m_damage);
+
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        foreach (const QRect &rect, m_damage.rects())
+            painter.fillRect(rect, m_clearColor);
+
+        painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+        foreach (const SoftwareLayer &layer, m_layers) {
+            QRect geometry(layer.position, layer.image.size());
+            if (m_damage.intersects(geometry))
+                painter.drawImage(layer.position, layer.image);
+        }
+    }
+
+private:
+    uchar *m_bits;
+    int m_bytesPerLine;
+    QRect m_tile;
+    QRegion m_damage;
+    QVector<SoftwareLayer> m_layers;
+    QColor m_clearColor;
+};
+
+class QWaylandSoftwareOutputPrivate
+{
+public:
+    QWaylandSoftwareOutputPrivate()
+        : clearColor(Qt::black)
+        , outputDamage(Q_NULLPTR)
+        , dirty(false)
+    {
+    }
+
+    QImage framebuffer;
+    QRegion damage;
+    QColor clearColor;
+
+    QWaylandOutputDamage *outputDamage;
+    QSet<QObject *> trackedSurfaces;
+
+    QTimer vsyncTimer;
+    QThreadPool tilePool;
+    bool dirty;
+};
+
+QWaylandSoftwareOutput::QWaylandSoftwareOutput(QWaylandCompositor *compositor, const QSize &size,
+                                               const QString &manufacturer, const QString &model)
+    : QWaylandOutput(compositor, Q_NULLPTR, manufacturer, model)
+    , d(new QWaylandSoftwareOutputPrivate)
+{
+    setMode({size, mode().refreshRate});
+    d->outputDamage = new QWaylandOutputDamage(this);
+    // The framebuffer always holds the previous frame
+    d->outputDamage->setMaxBufferAge(1);
+    resizeFramebuffer();
+
+    d->vsyncTimer.setTimerType(Qt::PreciseTimer);
+    connect(&d->vsyncTimer, &QTimer::timeout, this, &QWaylandSoftwareOutput::vsync);
+    connect(this, &QWaylandOutput::modeChanged, this, &QWaylandSoftwareOutput::resizeFramebuffer);
+    connect(this, &QWaylandOutput::cursorChanged, this, &QWaylandSoftwareOutput::cursorDamaged);
+
+    // Surfaces showing up on an idle output have to restart the refresh
+    connect(this, &QWaylandOutput::surfaceEntered, this, &QWaylandSoftwareOutput::trackSurface);
+    connect(this, &QWaylandOutput::surfaceLeft, this, &QWaylandSoftwareOutput::surfaceCommitted);
+    Q_FOREACH (QWaylandSurface *surface, surfaces())
+        trackSurface(surface);
+}
+
+QWaylandSoftwareOutput::~QWaylandSoftwareOutput()
+{
+    d->tilePool.waitForDone();
+    delete d;
+}
+
+/*!
+    Schedules a frame on the next refresh. Only the parts of the framebuffer
+    that changed since the previous frame are repainted.
+*/
+void QWaylandSoftwareOutput::update()
+{
+    d->dirty = true;
+    if (!d->vsyncTimer.isActive())
+        d->vsyncTimer.start(1000 / qMax(1, mode().refreshRate));
+}
+
+/*!
+    Returns the composited output. The image shares its memory with the output,
+    so keeping a copy alive past the next frame forces a detach.
+*/
+QImage QWaylandSoftwareOutput::framebuffer() const
+{
+    return d->framebuffer;
+}
+
+/*!
+    Returns the region of the framebuffer that changed in the last rendered frame.
+*/
+QRegion QWaylandSoftwareOutput::damage() const
+{
+    return d->damage;
+}
+
+QColor QWaylandSoftwareOutput::clearColor() const
+{
+    return d->clearColor;
+}
+
+void QWaylandSoftwareOutput::setClearColor(const QColor &color)
+{
+    if (d->clearColor == color)
+        return;
+
+    d->clearColor = color;
+    d->outputDamage->invalidate();
+    update();
+}
+
+/*!
+    Returns the views to composite, bottom-most first. The default implementation
+    returns the views of every mapped surface on this output in creation order.
+    Reimplement it to apply the embedder's window stacking.
+*/
+QList<QWaylandSurfaceView *> QWaylandSoftwareOutput::stackingOrder() const
+{
+    QList<QWaylandSurfaceView *> views;
+    Q_FOREACH (QWaylandSurface *surface, surfaces()) {
+        if (!surface->isMapped() || surface->handle()->isCursorSurface())
+            continue;
+        views << surface->views();
+    }
+    return views;
+}
+
+/*!
+    Composites the damaged parts of the framebuffer right away, without waiting
+    for the next refresh. Frame callbacks are not sent.
+*/
+void QWaylandSoftwareOutput::render()
+{
+    const QPoint origin = position();
+    const QRect bounds(QPoint(), d->framebuffer.size());
+
+    const QList<QWaylandSurfaceView *> views = stackingOrder();
+    d->outputDamage->setViews(views);
+
+    QVector<SoftwareLayer> layers;
+    Q_FOREACH (QWaylandSurfaceView *view, views) {
+        // Reimplemented stacking orders may show surfaces of other outputs
+        QWaylandSurface *surface = view->surface();
+        trackSurface(surface);
+
+        QWaylandBufferRef buffer = surface->handle()->currentBuffer();
+        if (!buffer || !buffer.isShm())
+            continue;
+
+        SoftwareLayer layer;
+        layer.image = buffer.image();
+        layer.position = view->pos().toPoint() - origin;
+        layers << layer;
+    }
+
+    // The cursor is the top-most layer; its damage comes from cursorChanged()
+    if (cursorSurface()) {
+        QWaylandBufferRef buffer = cursorSurface()->handle()->currentBuffer();
+        if (buffer && buffer.isShm()) {
+            SoftwareLayer layer;
+            layer.image = buffer.image();
+            layer.position = cursorGeometry().topLeft();
+            layers << layer;
+        }
+    }
+
+    const QRegion damage = d->outputDamage->damageSince(1) & bounds;
+    d->outputDamage->endFrame();
+    d->damage = damage;
+    if (damage.isEmpty()) {
+        updateCaptures(d->framebuffer, damage);
+        return;
+    }
+
+    uchar *bits = d->framebuffer.bits();
+    const int bytesPerLine = d->framebuffer.bytesPerLine();
+    QVector<SoftwareTileJob *> jobs;
+    for (int y = 0; y < bounds.height(); y += tileHeight) {
+        const QRect tile(0, y, bounds.width(), qMin(tileHeight, bounds.height() - y));
+        const QRegion tileDamage = damage & tile;
+        if (!tileDamage.isEmpty())
+            jobs << new SoftwareTileJob(bits, bytesPerLine, tile, tileDamage, layers, d->clearColor);
+    }
+
+    // Render the last tile on this thread while the pool handles the others
+    SoftwareTileJob *last = jobs.takeLast();
+    foreach (SoftwareTileJob *job, jobs)
+        d->tilePool.start(job);
+    last->run();
+    delete last;
+    d->tilePool.waitForDone();
+
+    updateCaptures(d->framebuffer, damage);
+    Q_EMIT frameRendered(damage);
+}
+
+void QWaylandSoftwareOutput::trackSurface(QWaylandSurface *surface)
+{
+    if (d->trackedSurfaces.contains(surface))
+        return;
+
+    connect(surface, &QWaylandSurface::redraw, this, &QWaylandSoftwareOutput::surfaceCommitted);
+    connect(surface, &QWaylandSurface::mapped, this, &QWaylandSoftwareOutput::surfaceCommitted);
+    connect(surface, &QWaylandSurface::unmapped, this, &QWaylandSoftwareOutput::surfaceCommitted);
+    connect(surface, &QObject::destroyed, this, &QWaylandSoftwareOutput::surfaceObjectDestroyed);
+    d->trackedSurfaces.insert(surface);
+    surfaceCommitted();
+}
+
+void QWaylandSoftwareOutput::surfaceCommitted()
+{
+    d->dirty = true;
+    if (!d->vsyncTimer.isActive())
+        d->vsyncTimer.start(1000 / qMax(1, mode().refreshRate));
+}
+
+void QWaylandSoftwareOutput::surfaceObjectDestroyed(QObject *object)
+{
+    d->trackedSurfaces.remove(object);
+    surfaceCommitted();
+}
+
+void QWaylandSoftwareOutput::cursorDamaged(const QRegion &damage)
+{
+    d->outputDamage->addDamage(damage);
+    update();
+}
+
+void QWaylandSoftwareOutput::resizeFramebuffer()
+{
+    if (d->framebuffer.size() == mode().size)
+        return;
+
+    d->framebuffer = QImage(mode().size, QImage::Format_ARGB32_Premultiplied);
+    d->framebuffer.fill(d->clearColor);
+    d->outputDamage->invalidate();
+    update();
+}
+
+void QWaylandSoftwareOutput::vsync()
+{
+    // Stop ticking once a refresh went by without anything to show
+    if (!d->dirty) {
+        d->vsyncTimer.stop();
+        return;
+    }
+    d->dirty = false;
+
+    compositor()->frameStarted();
+    compositor()->cleanupGraphicsResources();
+    render();
+    compositor()->sendFrameCallbacks(surfaces());
+}
+
+QT_END_NAMESPACE
@@ -284,6 +284,15 @@ QVariantMap QWaylandSurface::windowProperties() const
     return d->extendedSurface()->windowProperties();
 }
 
+QVariant QWaylandSurface::windowProperty(const QString &name) const
+{
+    Q_D(const QWaylandSurface);
+    if (!d->extendedSurface())
+        return QVariant();
+
+    return d->extendedSurface()->windowProperty(name);
+}
+
 void QWaylandSurface::setWindowProperty(const QString &name, const QVariant &value)
 {
     Q_D(QWaylandSurface);
@@ -291,6 +300,8 @@ void QWaylandSurface::setWindowProperty(const QString &name, const QVariant &val
         return;
 
     d->extendedSurface()->setWindowProperty(name, value);
+    if (QWaylandClient *c = client())
+        d->compositor()->scheduleFlush(c);
 }
 
 QWaylandCompositor *QWaylandSurface::compositor() const
@@ -313,8 +324,11 @@ void QWaylandSurface::setMainOutput(QWaylandOutput *mainOutput)
 {
     Q_D(QWaylandSurface);
 
-    if (mainOutput)
+    if (mainOutput) {
         d->setMainOutput(mainOutput->handle());
+        if (QWaylandClient *c = client())
+            d->compositor()->scheduleFlush(c);
+    }
 }
 
 QList<QWaylandOutput *> QWaylandSurface::outputs() const
@@ -352,8 +366,12 @@ bool QWaylandSurface::sendInterfaceOp(QWaylandSurfaceOp &op)
 {
     Q_D(QWaylandSurface);
     foreach (QWaylandSurfaceInterface *iface, d->interfaces) {
-        if (iface->runOperation(&op))
+        if (iface->runOperation(&op)) {
+            // Operations are run outside of request dispatch
+            if (QWaylandClient *c = client())
+                d->compositor()->scheduleFlush(c);
             return true;
+        }
     }
     return false;
 }
@@ -402,10 +420,25 @@ bool QWaylandSurface::transientInactive() const
     return d->transientInactive();
 }
 
+/*!
+ * \return True if the input region of the surface contains the point \a p, in
+ * surface coordinates.
+ */
 bool QWaylandSurface::inputRegionContains(const QPoint &p) const
 {
     Q_D(const QWaylandSurface);
-    return d->inputRegion().contains(p);
+    return d->inputRegionContains(p);
+}
+
+/*!
+ * \overload
+ *
+ * A point belongs to the pixel it lies in.
+ */
+bool QWaylandSurface::inputRegionContains(const QPointF &p) const
+{
+    Q_D(const QWaylandSurface);
+    return d->inputRegionContains(p);
 }
 
 void QWaylandSurface::destroy()
@@ -192,6 +192,7 @@ public:
 
     QByteArray authenticationToken() const;
     QVariantMap windowProperties() const;
+    QVariant windowProperty(const QString &name) const;
     void setWindowProperty(const QString &name, const QVariant &value);
 
     QWaylandCompositor *compositor() const;
@@ -210,6 +211,7 @@ public:
     bool transientInactive() const;
 
     bool inputRegionContains(const QPoint &p) const;
+    bool inputRegionContains(const QPointF &p) const;
 
     Q_INVOKABLE void destroy();
     Q_INVOKABLE void destroySurface();
@@ -253,6 +255,7 @@ Q_SIGNALS:
     void visibilityChanged();
     void pong();
     void surfaceDestroyed();
+    void viewRemoved(QWaylandSurfaceView *view);
 
     void configure(bool hasBuffer);
     void redraw();
@@ -139,12 +139,29 @@ QSGTextureProvider *QWaylandSurfaceItem::textureProvider() const
     return m_provider;
 }
 
+// Points outside the input region go to the items below
+bool QWaylandSurfaceItem::contains(const QPointF &point) const
+{
+    return surface() && inputRegionContains(point);
+}
+
+// The item may be scaled to a size other than the surface's, so item
+// coordinates are mapped to surface coordinates before hit-testing
+bool QWaylandSurfaceItem::inputRegionContains(const QPointF &point) const
+{
+    const QSize size = surface()->size();
+    if (size.isEmpty() || width() <= 0 || height() <= 0)
+        return surface()->inputRegionContains(point);
+    return surface()->inputRegionContains(QPointF(point.x() * size.width() / width(),
+                                                  point.y() * size.height() / height()));
+}
+
 void QWaylandSurfaceItem::mousePressEvent(QMouseEvent *event)
 {
     if (!surface())
         return;
 
-    if (!surface()->inputRegionContains(event->pos())) {
+    if (!inputRegionContains(event->pos())) {
         event->ignore();
         return;
     }
@@ -174,31 +191,31 @@ void QWaylandSurfaceItem::mouseReleaseEvent(QMouseEvent *event)
 void QWaylandSurfaceItem::hoverEnterEvent(QHoverEvent *event)
 {
     if (surface()) {
-        if (!surface()->inputRegionContains(event->pos())) {
+        if (!inputRegionContains(event->pos())) {
             event->ignore();
             return;
         }
         QWaylandInputDevice *inputDevice = compositor()->inputDeviceFor(event);
-        inputDevice->sendMouseMoveEvent(this, event->pos());
+        inputDevice->sendMouseMoveEvent(this, event->posF(), mapToScene(event->posF()));
     }
 }
 
 void QWaylandSurfaceItem::hoverMoveEvent(QHoverEvent *event)
 {
     if (surface()) {
-        if (!surface()->inputRegionContains(event->pos())) {
+        if (!inputRegionContains(event->pos())) {
             event->ignore();
             return;
         }
         QWaylandInputDevice *inputDevice = compositor()->inputDeviceFor(event);
-        inputDevice->sendMouseMoveEvent(this, event->pos());
+        inputDevice->sendMouseMoveEvent(this, event->posF(), mapToScene(event->posF()));
     }
 }
 
 void QWaylandSurfaceItem::wheelEvent(QWheelEvent *event)
 {
     if (surface()) {
-        if (!surface()->inputRegionContains(event->pos())) {
+        if (!inputRegionContains(event->pos())) {
             event->ignore();
             return;
         }
@@ -240,7 +257,7 @@ void QWaylandSurfaceItem::touchEvent(QTouchEvent *event)
         if (!points.isEmpty())
             pointPos = points.at(0).pos().toPoint();
 
-        if (event->type() == QEvent::TouchBegin && !surface()->inputRegionContains(pointPos)) {
+        if (event->type() == QEvent::TouchBegin && !inputRegionContains(pointPos)) {
             event->ignore();
             return;
         }
@@ -88,6 +88,8 @@ public:
     void setPos(const QPointF &pos) Q_DECL_OVERRIDE;
     QPointF pos() const Q_DECL_OVERRIDE;
 
+    bool contains(const QPointF &point) const Q_DECL_OVERRIDE;
+
 protected:
     void mousePressEvent(QMouseEvent *event);
     void mouseMoveEvent(QMouseEvent *event);
@@ -128,6 +130,7 @@ private:
     friend class QWaylandQuickSurface;
     void init(QWaylandQuickSurface *);
     void updateTexture(bool changed);
+    bool inputRegionContains(const QPointF &point) const;
 
     static QMutex *mutex;
 
@@ -63,6 +63,7 @@ QWaylandSurfaceView::~QWaylandSurfaceView()
         if (i->mouseFocus() == this)
             i->setMouseFocus(Q_NULLPTR, QPointF());
 
+        Q_EMIT d->surface->viewRemoved(this);
         d->surface->destroy();
         d->surface->d_func()->views.removeOne(this);
     }
@@ -68,6 +68,7 @@
 #include <QWindow>
 #include <QSocketNotifier>
 #include <QScreen>
+#include <QTouchEvent>
 #include <qpa/qplatformscreen.h>
 #include <QGuiApplication>
 #include <QDebug>
@@ -82,6 +83,7 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <poll.h>
 
 #include <sys/mman.h>
 #include <sys/select.h>
@@ -162,10 +164,13 @@ Compositor *Compositor::instance()
 Compositor::Compositor(QWaylandCompositor *qt_compositor, QWaylandCompositor::ExtensionFlags extensions)
     : m_extensions(extensions)
     , m_display(new Display)
+    , m_touchRouteCache(false)
     , m_current_frame(0)
     , m_last_queued_buf(-1)
     , m_qt_compositor(qt_compositor)
     , m_orientation(Qt::PrimaryOrientation)
+    , m_flushAllClients(false)
+    , m_flushScheduled(false)
 #if defined (QT_COMPOSITOR_WAYLAND_GL)
     , m_hw_integration(0)
     , m_client_buffer_integration(0)
@@ -180,10 +185,15 @@ Compositor::Compositor(QWaylandCompositor *qt_compositor, QWaylandCompositor::Ex
     , m_inputPanel()
     , m_eventHandler(new WindowSystemEventHandler(this))
     , m_retainSelection(false)
+    , m_earlyShmBufferRelease(false)
+    , m_pingInterval(0)
+    , m_unresponsiveTimeout(5000)
 {
     m_timer.start();
     compositor = this;
 
+    connect(&m_pingTimer, SIGNAL(timeout()), this, SLOT(pingClients()));
+
     QWindowSystemInterfacePrivate::installWindowSystemEventHandler(m_eventHandler.data());
 }
 
@@ -217,7 +227,7 @@ void Compositor::init()
     connect(sockNot, SIGNAL(activated(int)), this, SLOT(processWaylandEvents()));
 
     QAbstractEventDispatcher *dispatcher = QGuiApplicationPrivate::eventDispatcher;
-    connect(dispatcher, SIGNAL(aboutToBlock()), this, SLOT(processWaylandEvents()));
+    connect(dispatcher, SIGNAL(aboutToBlock()), this, SLOT(processWaylandEventsAndFlush()));
 
     qRegisterMetaType<SurfaceBuffer*>("SurfaceBuffer*");
     qRegisterMetaType<QWaylandClient*>("WaylandClient*");
@@ -254,8 +264,9 @@ void Compositor::sendFrameCallbacks(QList<QWaylandSurface *> visibleSurfaces)
 {
     foreach (QWaylandSurface *surface, visibleSurfaces) {
         surface->handle()->sendFrameCallback();
+        if (QWaylandClient *client = surface->client())
+            scheduleFlush(client);
     }
-    wl_display_flush_clients(m_display->handle());
 }
 
 uint Compositor::currentTimeMsecs() const
@@ -314,17 +325,74 @@ void Compositor::setPrimaryOutput(QWaylandOutput *output)
     m_outputs.prepend(output);
 }
 
-void Compositor::processWaylandEvents()
+void Compositor::dispatchWaylandEvents()
 {
     int ret = wl_event_loop_dispatch(m_loop, 0);
     if (ret)
         fprintf(stderr, "wl_event_loop_dispatch error: %d\n", ret);
-    wl_display_flush_clients(m_display->handle());
+}
+
+void Compositor::processWaylandEvents()
+{
+    dispatchWaylandEvents();
+    // Any client may have been sent events from the request handlers
+    scheduleFlush();
+}
+
+void Compositor::processWaylandEventsAndFlush()
+{
+    // Request handlers may send events to any client, so only a dispatch
+    // which actually reads requests makes everybody dirty. Events sent
+    // outside of the dispatch mark their client dirty when queued.
+    struct pollfd pfd = { wl_event_loop_get_fd(m_loop), POLLIN, 0 };
+    if (poll(&pfd, 1, 0) > 0)
+        m_flushAllClients = true;
+
+    // Nothing may be posted from here, as that would wake the event loop up
+    // again right away and it would never go to sleep
+    dispatchWaylandEvents();
+    flushClients();
+}
+
+/*!
+ * Marks \a client, or every client if it is null, as having events queued.
+ * Dirty clients are flushed once at the end of the current event loop
+ * iteration, however many times they were marked.
+ */
+void Compositor::scheduleFlush(QWaylandClient *client)
+{
+    if (client)
+        m_dirtyClients.insert(client);
+    else
+        m_flushAllClients = true;
+
+    if (!m_flushScheduled) {
+        m_flushScheduled = true;
+        QMetaObject::invokeMethod(this, "flushClients", Qt::QueuedConnection);
+    }
+}
+
+void Compositor::flushClients()
+{
+    m_flushScheduled = false;
+
+    if (m_flushAllClients) {
+        // A single pass over every client, including the ones which do not
+        // have a QWaylandClient
+        wl_display_flush_clients(m_display->handle());
+    } else {
+        foreach (QWaylandClient *client, m_dirtyClients)
+            client->flush();
+    }
+
+    m_flushAllClients = false;
+    m_dirtyClients.clear();
 }
 
 void Compositor::destroySurface(Surface *surface)
 {
     m_surfaces.removeOne(surface);
+    m_focusIndex.remove(surface);
 
     waylandCompositor()->surfaceAboutToBeDestroyed(surface->waylandSurface());
 
@@ -334,7 +402,9 @@ void Compositor::destroySurface(Surface *surface)
 
 void Compositor::resetInputDevice(Surface *surface)
 {
-    foreach (QWaylandInputDevice *dev, m_inputDevices) {
+    // Only the devices that ever focused this surface can still have it as focus
+    const QList<QWaylandInputDevice *> devices = m_focusIndex.take(surface);
+    foreach (QWaylandInputDevice *dev, devices) {
         if (dev->keyboardFocus() == surface->waylandSurface())
             dev->setKeyboardFocus(0);
         if (dev->mouseFocus() && dev->mouseFocus()->surface() == surface->waylandSurface())
@@ -342,6 +412,15 @@ void Compositor::resetInputDevice(Surface *surface)
     }
 }
 
+void Compositor::inputFocusChanged(QWaylandInputDevice *device, Surface *surface)
+{
+    if (!surface || !device)
+        return;
+    QList<QWaylandInputDevice *> &devices = m_focusIndex[surface];
+    if (!devices.contains(device))
+        devices.append(device);
+}
+
 void Compositor::cleanupGraphicsResources()
 {
     qDeleteAll(m_destroyed_surfaces);
@@ -482,6 +561,49 @@ bool Compositor::retainedSelectionEnabled() const
     return m_retainSelection;
 }
 
+void Compositor::setEarlyShmBufferReleaseEnabled(bool enabled)
+{
+    m_earlyShmBufferRelease = enabled;
+}
+
+void Compositor::setTouchRouteCacheEnabled(bool enabled)
+{
+    m_touchRouteCache = enabled;
+    m_touchRoutes.clear();
+}
+
+void Compositor::setPingInterval(int msecs)
+{
+    m_pingInterval = msecs;
+    if (msecs > 0)
+        m_pingTimer.start(msecs);
+    else
+        m_pingTimer.stop();
+}
+
+// Returns true if the pong answers a liveness ping of the compositor
+bool Compositor::handlePong(wl_client *client, uint32_t serial)
+{
+    return QWaylandClient::fromWlClient(client)->pong(serial);
+}
+
+void Compositor::pingClients()
+{
+    foreach (QWaylandClient *client, m_clients)
+        client->checkResponsive(m_unresponsiveTimeout);
+
+    // One ping per client is enough, through any of its mapped surfaces
+    QSet<QWaylandClient *> pinged;
+    foreach (Surface *surface, m_surfaces) {
+        QWaylandSurface *waylandSurface = surface->waylandSurface();
+        if (!waylandSurface->isMapped())
+            continue;
+        QWaylandClient *client = waylandSurface->client();
+        if (!pinged.contains(client) && client->ping(waylandSurface))
+            pinged.insert(client);
+    }
+}
+
 void Compositor::feedRetainedSelectionData(QMimeData *data)
 {
     if (m_retainSelection)
@@ -569,15 +691,49 @@ void Compositor::registerInputDevice(QWaylandInputDevice *device)
     // is assumed to be the default and it will claim to accept all the input
     // events if asked
     m_inputDevices.prepend(device);
+    m_touchRoutes.clear();
 }
 
 void Compositor::removeInputDevice(QWaylandInputDevice *device)
 {
     m_inputDevices.removeOne(device);
+    m_touchRoutes.clear();
+
+    QHash<Surface *, QList<QWaylandInputDevice *> >::iterator it = m_focusIndex.begin();
+    while (it != m_focusIndex.end()) {
+        it->removeAll(device);
+        if (it->isEmpty())
+            it = m_focusIndex.erase(it);
+        else
+            ++it;
+    }
 }
 
 QWaylandInputDevice *Compositor::inputDeviceFor(QInputEvent *inputEvent)
 {
+    // Key and mouse events do not say which device they came from, so only
+    // touch events can be routed without asking every device.
+    const QTouchDevice *touchDevice = 0;
+    switch (inputEvent->type()) {
+    case QEvent::TouchBegin:
+    case QEvent::TouchUpdate:
+    case QEvent::TouchEnd:
+    case QEvent::TouchCancel:
+        touchDevice = static_cast<QTouchEvent *>(inputEvent)->device();
+        break;
+    default:
+        break;
+    }
+
+    if (!m_touchRouteCache)
+        touchDevice = 0;
+
+    if (touchDevice) {
+        QHash<const QTouchDevice *, QWaylandInputDevice *>::const_iterator it = m_touchRoutes.constFind(touchDevice);
+        if (it != m_touchRoutes.constEnd())
+            return it.value();
+    }
+
     QWaylandInputDevice *dev = NULL;
     for (int i = 0; i < m_inputDevices.size(); i++) {
         QWaylandInputDevice *candidate = m_inputDevices.at(i);
@@ -586,6 +742,9 @@ QWaylandInputDevice *Compositor::inputDeviceFor(QInputEvent *inputEvent)
             break;
         }
     }
+
+    if (touchDevice && dev)
+        m_touchRoutes.insert(touchDevice, dev);
     return dev;
 }
 
@@ -48,7 +48,9 @@
 #include <QtCompositor/private/qwayland-server-wayland.h>
 
 #include <QtCore/QElapsedTimer>
+#include <QtCore/QHash>
 #include <QtCore/QSet>
+#include <QtCore/QTimer>
 
 #include <private/qwldisplay_p.h>
 
@@ -59,6 +61,7 @@ QT_BEGIN_NAMESPACE
 class QWaylandClient;
 class QWaylandClientPrivate;
 class QInputEvent;
+class QTouchDevice;
 
 class QWaylandCompositor;
 class QWaylandInputDevice;
@@ -102,6 +105,7 @@ public:
     QList<QWaylandInputDevice *> inputDevices() const { return m_inputDevices; }
     QWaylandInputDevice *inputDeviceFor(QInputEvent *inputEvent);
     void removeInputDevice(QWaylandInputDevice *device);
+    void inputFocusChanged(QWaylandInputDevice *device, Surface *surface);
 
     void destroySurface(Surface *surface);
 
@@ -157,23 +161,38 @@ public:
 
     void setRetainedSelectionEnabled(bool enabled);
     bool retainedSelectionEnabled() const;
+    void setEarlyShmBufferReleaseEnabled(bool enabled);
+    bool earlyShmBufferReleaseEnabled() const { return m_earlyShmBufferRelease; }
+    void setPingInterval(int msecs);
+    int pingInterval() const { return m_pingInterval; }
+    void setUnresponsiveTimeout(int msecs) { m_unresponsiveTimeout = msecs; }
+    int unresponsiveTimeout() const { return m_unresponsiveTimeout; }
+    void setTouchRouteCacheEnabled(bool enabled);
+    bool touchRouteCacheEnabled() const { return m_touchRouteCache; }
+    bool handlePong(wl_client *client, uint32_t serial);
     void overrideSelection(const QMimeData *data);
     void feedRetainedSelectionData(QMimeData *data);
 
     static void bindGlobal(wl_client *client, void *data, uint32_t version, uint32_t id);
     void resetInputDevice(Surface *surface);
 
+    void scheduleFlush(QWaylandClient *client = 0);
+
 public slots:
     void cleanupGraphicsResources();
+    void flushClients();
 
 protected:
     void compositor_create_surface(Resource *resource, uint32_t id) Q_DECL_OVERRIDE;
     void compositor_create_region(Resource *resource, uint32_t id) Q_DECL_OVERRIDE;
 private slots:
     void processWaylandEvents();
+    void processWaylandEventsAndFlush();
+    void pingClients();
 
 protected:
     void loadClientBufferIntegration();
+    void dispatchWaylandEvents();
     void loadServerBufferIntegration();
 
     QWaylandCompositor::ExtensionFlags m_extensions;
@@ -185,6 +204,13 @@ protected:
     QWaylandInputDevice *m_default_wayland_input_device;
 
     QList<QWaylandInputDevice *> m_inputDevices;
+    // Touch events carry their QTouchDevice, so when enabled the owning input
+    // device is cached per device after the first isOwner() scan.
+    QHash<const QTouchDevice *, QWaylandInputDevice *> m_touchRoutes;
+    bool m_touchRouteCache;
+    // Input devices that have had keyboard or pointer focus on a surface. May
+    // contain stale entries; resetInputDevice() re-checks the actual focus.
+    QHash<Surface *, QList<QWaylandInputDevice *> > m_focusIndex;
 
     /* Output */
     QList<QWaylandOutput *> m_outputs;
@@ -205,6 +231,11 @@ protected:
     Qt::ScreenOrientation m_orientation;
     QList<QWaylandClient *> m_clients;
 
+    /* Flushing */
+    QSet<QWaylandClient *> m_dirtyClients;
+    bool m_flushAllClients;
+    bool m_flushScheduled;
+
 #ifdef QT_COMPOSITOR_WAYLAND_GL
     QScopedPointer<HardwareIntegration> m_hw_integration;
     QScopedPointer<ClientBufferIntegration> m_client_buffer_integration;
@@ -227,6 +258,12 @@ protected:
                           uint32_t version, uint32_t id);
 
     bool m_retainSelection;
+    bool m_earlyShmBufferRelease;
+
+    /* Liveness */
+    QTimer m_pingTimer;
+    int m_pingInterval;
+    int m_unresponsiveTimeout;
 
     friend class QT_PREPEND_NAMESPACE(QWaylandCompositor);
     friend class QT_PREPEND_NAMESPACE(QWaylandClient);
@@ -0,0 +1,218 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the Qt Compositor.
+**
+** $QT_BEGIN_LICENSE:BSD$
+** You may use this file under the terms of the BSD license as follows:
+**
+** "Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are
+** met:
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in
+**     the documentation and/or other materials provided with the
+**     distribution.
+**   * Neither the name of The Qt Company Ltd nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qwldamageaccumulator_p.h"
+
+#include <limits>
+
+QT_BEGIN_NAMESPACE
+
+namespace QtWayland {
+
+// Exact accumulators unite their pending rectangles at the latest after this
+// many, so that a client adding rectangles forever cannot grow the list
+static const int maxPendingRects = 1024;
+
+static inline qint64 area(const QRect &rect)
+{
+    return qint64(rect.width()) * rect.height();
+}
+
+// Uniting rectangles one by one into a QRegion gets slower with every
+// rectangle, uniting them pairwise keeps the regions involved balanced
+static QRegion unite(const QRect *rects, int count)
+{
+    if (count == 0)
+        return QRegion();
+    if (count == 1)
+        return QRegion(rects[0]);
+    const int half = count / 2;
+    return unite(rects, half).united(unite(rects + half, count - half));
+}
+
+/*!
+    \class QtWayland::DamageAccumulator
+    \internal
+
+    Collects rectangles sent by clients without doing region arithmetic for
+    every one of them.
+
+    A Bounded accumulator keeps at most maxRects rectangles. Past that it
+    merges the two rectangles whose bounding rectangle adds the least area,
+    and once the rectangles cover most of their bounding rectangle they are
+    replaced by it. The result covers at least everything that was added,
+    which is what damage needs.
+
+    An Exact accumulator keeps what was added until the region is asked for
+    or a rectangle is subtracted, and then unites it in one go. It is meant
+    for opaque and input regions, which must not grow.
+*/
+DamageAccumulator::DamageAccumulator(Mode mode, int maxRects)
+    : m_mode(mode)
+    , m_maxRects(qMax(1, maxRects))
+    , m_area(0)
+{
+}
+
+void DamageAccumulator::add(const QRect &rect)
+{
+    if (rect.isEmpty())
+        return;
+
+    if (m_mode == Exact) {
+        m_rects.append(rect);
+        if (m_rects.size() >= maxPendingRects)
+            flush();
+        return;
+    }
+
+    // Nothing to do for what is covered already, and nothing to keep of
+    // what the new rectangle covers
+    for (int i = 0; i < m_rects.size(); ++i) {
+        if (m_rects.at(i).contains(rect))
+            return;
+    }
+    for (int i = m_rects.size() - 1; i >= 0; --i) {
+        if (rect.contains(m_rects.at(i))) {
+            m_area -= area(m_rects.at(i));
+            m_rects.remove(i);
+        }
+    }
+
+    m_rects.append(rect);
+    m_area += area(rect);
+    m_bounds |= rect;
+
+    if (m_rects.size() > m_maxRects)
+        mergeCheapestPair();
+
+    // Overlaps are counted twice, so this errs towards collapsing
+    if (m_rects.size() > 1 && m_area * 4 >= area(m_bounds) * 3) {
+        m_rects.resize(1);
+        m_rects[0] = m_bounds;
+        m_area = area(m_bounds);
+    }
+}
+
+void DamageAccumulator::mergeCheapestPair()
+{
+    int first = 0;
+    int second = 1;
+    qint64 bestCost = std::numeric_limits<qint64>::max();
+    for (int i = 0; i < m_rects.size(); ++i) {
+        const QRect &a = m_rects.at(i);
+        for (int j = i + 1; j < m_rects.size(); ++j) {
+            const QRect &b = m_rects.at(j);
+            const qint64 cost = area(a | b) - area(a) - area(b);
+            if (cost < bestCost) {
+                bestCost = cost;
+                first = i;
+                second = j;
+            }
+        }
+    }
+
+    m_area -= area(m_rects.at(first)) + area(m_rects.at(second));
+    m_rects[first] |= m_rects.at(second);
+    m_rects.remove(second);
+    m_area += area(m_rects.at(first));
+}
+
+// Only Exact accumulators can subtract; taking something off damage would
+// lose updates
+void DamageAccumulator::subtract(const QRect &rect)
+{
+    Q_ASSERT(m_mode == Exact);
+    if (rect.isEmpty())
+        return;
+    flush();
+    m_region -= rect;
+}
+
+void DamageAccumulator::clear()
+{
+    m_rects.clear();
+    m_region = QRegion();
+    m_bounds = QRect();
+    m_area = 0;
+}
+
+bool DamageAccumulator::isEmpty() const
+{
+    return m_rects.isEmpty() && m_region.isEmpty();
+}
+
+int DamageAccumulator::rectCount() const
+{
+    if (m_mode == Exact) {
+        flush();
+        return m_region.rectCount();
+    }
+    return m_rects.size();
+}
+
+QRect DamageAccumulator::boundingRect() const
+{
+    if (m_mode == Exact) {
+        flush();
+        return m_region.boundingRect();
+    }
+    return m_bounds;
+}
+
+QRegion DamageAccumulator::region() const
+{
+    if (m_mode == Bounded)
+        return unite(m_rects.constData(), m_rects.size());
+    flush();
+    return m_region;
+}
+
+void DamageAccumulator::flush() const
+{
+    if (m_rects.isEmpty())
+        return;
+    m_region += unite(m_rects.constData(), m_rects.size());
+    m_rects.clear();
+}
+
+}
+
+QT_END_NAMESPACE
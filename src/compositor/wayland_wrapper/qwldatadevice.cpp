@@ -127,6 +127,11 @@ QWaylandSurfaceView *DataDevice::dragIcon() const
     return m_dragIcon;
 }
 
+QWaylandSurfaceView *DataDevice::dragFocus() const
+{
+    return m_dragFocus;
+}
+
 void DataDevice::sourceDestroyed(DataSource *source)
 {
     if (m_selectionSource == source)
@@ -65,6 +65,7 @@ public:
     void setDragFocus(QWaylandSurfaceView *focus, const QPointF &localPosition);
 
     QWaylandSurfaceView *dragIcon() const;
+    QWaylandSurfaceView *dragFocus() const;
 
     void sourceDestroyed(DataSource *source);
 
@@ -42,13 +42,14 @@
 
 #include "qwlcompositor_p.h"
 #include "qwlsurface_p.h"
+#include "../shared/qwaylandpropertycodec.h"
 
 QT_BEGIN_NAMESPACE
 
 namespace QtWayland {
 
 SurfaceExtensionGlobal::SurfaceExtensionGlobal(Compositor *compositor)
-    : QtWaylandServer::qt_surface_extension(compositor->wl_display(), 1)
+    : QtWaylandServer::qt_surface_extension(compositor->wl_display(), 2)
 {
 }
 
@@ -78,11 +79,24 @@ ExtendedSurface::~ExtendedSurface()
 
 void ExtendedSurface::sendGenericProperty(const QString &name, const QVariant &variant)
 {
-    QByteArray byteValue;
-    QDataStream ds(&byteValue, QIODevice::WriteOnly);
-    ds << variant;
-    send_set_generic_property(name, byteValue);
+    if (resource()->version() < 2) {
+        QByteArray byteValue;
+        QDataStream ds(&byteValue, QIODevice::WriteOnly);
+        ds << variant;
+        send_set_generic_property(name, byteValue);
+        return;
+    }
+
+    uint id = m_propertyIds.value(name);
+    if (!id) {
+        id = m_propertyIds.size() + 1;
+        m_propertyIds.insert(name, id);
+        send_intern_property(id, name);
+    }
 
+    QByteArray data;
+    QWaylandPropertyCodec::encode(data, id, variant);
+    send_set_properties(data);
 }
 
 void ExtendedSurface::setVisibility(QWindow::Visibility visibility)
@@ -123,6 +137,34 @@ void ExtendedSurface::extended_surface_update_generic_property(Resource *resourc
     setWindowProperty(name,variantValue,false);
 }
 
+void ExtendedSurface::extended_surface_intern_property(Resource *resource, uint32_t id, const QString &name)
+{
+    Q_UNUSED(resource);
+    m_clientPropertyNames.insert(id, name);
+}
+
+void ExtendedSurface::extended_surface_update_properties(Resource *resource, struct wl_array *data)
+{
+    Q_UNUSED(resource);
+    const QByteArray records = QByteArray::fromRawData(static_cast<const char *>(data->data), data->size);
+    int offset = 0;
+    while (offset < records.size()) {
+        uint id;
+        QVariant value;
+        if (!QWaylandPropertyCodec::decode(records, offset, id, value)) {
+            qWarning("Malformed window property update");
+            return;
+        }
+
+        QHash<uint, QString>::const_iterator it = m_clientPropertyNames.constFind(id);
+        if (it == m_clientPropertyNames.constEnd()) {
+            qWarning("Window property update for unknown id %u", id);
+            continue;
+        }
+        setWindowProperty(it.value(), value, false);
+    }
+}
+
 Qt::ScreenOrientations ExtendedSurface::contentOrientationMask() const
 {
     return m_contentOrientationMask;
@@ -150,15 +192,9 @@ void ExtendedSurface::extended_surface_set_content_orientation_mask(Resource *re
         emit m_surface->waylandSurface()->orientationUpdateMaskChanged();
 }
 
-QVariantMap ExtendedSurface::windowProperties() const
-{
-    return m_windowProperties;
-}
-
 QVariant ExtendedSurface::windowProperty(const QString &propertyName) const
 {
-    QVariantMap props = m_windowProperties;
-    return props.value(propertyName);
+    return m_windowProperties.value(propertyName);
 }
 
 void ExtendedSurface::setWindowProperty(const QString &name, const QVariant &value, bool writeUpdateToClient)
@@ -48,6 +48,7 @@
 #include <QtCompositor/qwaylandsurface.h>
 #include <QtCompositor/qwaylandsurfaceinterface.h>
 
+#include <QtCore/QHash>
 #include <QtCore/QVariant>
 #include <QtCore/QLinkedList>
 #include <QtGui/QWindow>
@@ -93,7 +94,7 @@ public:
 
     QWaylandSurface::WindowFlags windowFlags() const { return m_windowFlags; }
 
-    QVariantMap windowProperties() const;
+    const QVariantMap &windowProperties() const { return m_windowProperties; }
     QVariant windowProperty(const QString &propertyName) const;
     void setWindowProperty(const QString &name, const QVariant &value, bool writeUpdateToClient = true);
 
@@ -110,10 +111,19 @@ private:
     QByteArray m_authenticationToken;
     QVariantMap m_windowProperties;
 
+    // Property ids announced by the client and the ones we announced to it
+    QHash<uint, QString> m_clientPropertyNames;
+    QHash<QString, uint> m_propertyIds;
+
     void extended_surface_update_generic_property(Resource *resource,
                                                   const QString &name,
                                                   struct wl_array *value) Q_DECL_OVERRIDE;
 
+    void extended_surface_intern_property(Resource *resource, uint32_t id,
+                                          const QString &name) Q_DECL_OVERRIDE;
+    void extended_surface_update_properties(Resource *resource,
+                                            struct wl_array *data) Q_DECL_OVERRIDE;
+
     void extended_surface_set_content_orientation_mask(Resource *resource,
                                                        int32_t orientation) Q_DECL_OVERRIDE;
 
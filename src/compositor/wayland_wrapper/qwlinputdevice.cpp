@@ -48,6 +48,7 @@
 #include "qwlqtkey_p.h"
 #include "qwaylandcompositor.h"
 #include "qwaylanddrag.h"
+#include "qwaylandclient.h"
 #include "qwlpointer_p.h"
 #include "qwlkeyboard_p.h"
 #include "qwltouch_p.h"
@@ -171,17 +172,24 @@ void InputDevice::seat_get_touch(wl_seat::Resource *resource, uint32_t id)
 
 void InputDevice::sendMousePressEvent(Qt::MouseButton button, const QPointF &localPos, const QPointF &globalPos)
 {
+    // Grabs may move the focus, the leave goes to the previous one
+    scheduleFlush();
     pointerDevice()->sendMousePressEvent(button, localPos, globalPos);
+    scheduleFlush();
 }
 
 void InputDevice::sendMouseReleaseEvent(Qt::MouseButton button, const QPointF &localPos, const QPointF &globalPos)
 {
+    scheduleFlush();
     pointerDevice()->sendMouseReleaseEvent(button, localPos, globalPos);
+    scheduleFlush();
 }
 
 void InputDevice::sendMouseMoveEvent(const QPointF &localPos, const QPointF &globalPos)
 {
+    scheduleFlush();
     pointerDevice()->sendMouseMoveEvent(localPos, globalPos);
+    scheduleFlush();
 }
 
 void InputDevice::sendMouseMoveEvent(QWaylandSurfaceView *surface, const QPointF &localPos, const QPointF &globalPos)
@@ -193,6 +201,7 @@ void InputDevice::sendMouseMoveEvent(QWaylandSurfaceView *surface, const QPointF
 void InputDevice::sendMouseWheelEvent(Qt::Orientation orientation, int delta)
 {
     pointerDevice()->sendMouseWheelEvent(orientation, delta);
+    scheduleFlush();
 }
 
 void InputDevice::sendTouchPointEvent(int id, double x, double y, Qt::TouchPointState state)
@@ -217,19 +226,27 @@ void InputDevice::sendTouchPointEvent(int id, double x, double y, Qt::TouchPoint
     default:
         break;
     }
+
+    scheduleFlush();
 }
 
 void InputDevice::sendTouchFrameEvent()
 {
     if (!m_touch.isNull()) {
         m_touch->sendFrame();
+        scheduleFlush();
     }
 }
 
 void InputDevice::sendTouchCancelEvent()
 {
+    TouchExtensionGlobal *ext = m_compositor->touchExtension();
+    if (ext)
+        ext->touchCanceled();
+
     if (!m_touch.isNull()) {
         m_touch->sendCancel();
+        scheduleFlush();
     }
 }
 
@@ -240,6 +257,8 @@ void InputDevice::sendFullKeyEvent(QKeyEvent *event)
         return;
     }
 
+    scheduleFlush();
+
     QtKeyExtensionGlobal *ext = m_compositor->qtkeyExtension();
     if (ext && ext->postQtKeyEvent(event, keyboardFocus()))
         return;
@@ -255,8 +274,8 @@ void InputDevice::sendFullKeyEvent(QKeyEvent *event)
 void InputDevice::sendFullKeyEvent(Surface *surface, QKeyEvent *event)
 {
     QtKeyExtensionGlobal *ext = m_compositor->qtkeyExtension();
-    if (ext)
-        ext->postQtKeyEvent(event, surface);
+    if (ext && ext->postQtKeyEvent(event, surface))
+        QtWayland::scheduleFlush(m_compositor, surface->waylandSurface());
 }
 
 void InputDevice::sendFullTouchEvent(QTouchEvent *event)
@@ -272,8 +291,10 @@ void InputDevice::sendFullTouchEvent(QTouchEvent *event)
     }
 
     TouchExtensionGlobal *ext = m_compositor->touchExtension();
-    if (ext && ext->postTouchEvent(event, mouseFocus()))
+    if (ext && ext->postTouchEvent(event, mouseFocus())) {
+        scheduleFlush();
         return;
+    }
 
     const QList<QTouchEvent::TouchPoint> points = event->touchPoints();
     if (points.isEmpty())
@@ -304,9 +325,11 @@ bool InputDevice::setKeyboardFocus(Surface *surface)
         return false;
 
     if (!m_keyboard.isNull()) {
+        scheduleFlush();
         m_keyboard->setFocus(surface);
         if (m_data_device)
             m_data_device->setFocus(m_keyboard->focusResource());
+        scheduleFlush();
         return true;
     }
     return false;
@@ -322,6 +345,8 @@ void InputDevice::setMouseFocus(QWaylandSurfaceView *view, const QPointF &localP
     if (view && view->surface()->handle()->isDestroyed())
         return;
 
+    scheduleFlush();
+
     if (!m_pointer.isNull()) {
         m_pointer->setMouseFocus(view, localPos, globalPos);
     }
@@ -331,6 +356,31 @@ void InputDevice::setMouseFocus(QWaylandSurfaceView *view, const QPointF &localP
         // No wl_touch_set_focus() is available so set it manually.
         m_touch->setFocus(view);
     }
+
+    scheduleFlush();
+}
+
+static void scheduleFlush(Compositor *compositor, QWaylandSurface *surface)
+{
+    if (QWaylandClient *client = surface ? surface->client() : 0)
+        compositor->scheduleFlush(client);
+}
+
+/*!
+ * Marks the clients which input is currently sent to as dirty. Input is sent
+ * outside of request dispatch, so the compositor has to be told which
+ * clients need a flush. Call it before a focus change too, for the leave.
+ */
+void InputDevice::scheduleFlush()
+{
+    if (Surface *surface = keyboardFocus())
+        QtWayland::scheduleFlush(m_compositor, surface->waylandSurface());
+    if (QWaylandSurfaceView *view = mouseFocus())
+        QtWayland::scheduleFlush(m_compositor, view->surface());
+    if (QWaylandSurfaceView *view = m_touch.isNull() ? 0 : m_touch->focusSurface())
+        QtWayland::scheduleFlush(m_compositor, view->surface());
+    if (QWaylandSurfaceView *view = m_data_device.isNull() ? 0 : m_data_device->dragFocus())
+        QtWayland::scheduleFlush(m_compositor, view->surface());
 }
 
 void InputDevice::clientRequestedDataDevice(DataDeviceManager *, struct wl_client *client, uint32_t id)
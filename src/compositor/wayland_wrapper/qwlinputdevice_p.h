@@ -126,6 +126,8 @@ public:
     QWaylandInputDevice::CapabilityFlags capabilities() { return m_capabilities; }
     void setCapabilities(QWaylandInputDevice::CapabilityFlags caps);
 
+    void scheduleFlush();
+
 private:
     QWaylandInputDevice *m_handle;
     QScopedPointer<QWaylandDrag> m_dragHandle;
@@ -81,6 +81,7 @@ void InputMethod::activate(TextInput *textInput)
     m_context = new InputMethodContext(m_resource->client(), textInput);
 
     send_activate(m_resource->handle, m_context->resource()->handle);
+    textInput->sendSurroundingText(m_context);
 
     m_compositor->inputPanel()->setFocus(textInput->focus());
     m_compositor->inputPanel()->setCursorRectangle(textInput->cursorRectangle());
@@ -0,0 +1,136 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the Qt Compositor.
+**
+** $QT_BEGIN_LICENSE:BSD$
+** You may use this file under the terms of the BSD license as follows:
+**
+** "Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are
+** met:
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in
+**     the documentation and/or other materials provided with the
+**     distribution.
+**   * Neither the name of The Qt Company Ltd nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qwlinputregion_p.h"
+
+#include <QtCore/qmath.h>
+
+#include <algorithm>
+
+QT_BEGIN_NAMESPACE
+
+namespace QtWayland {
+
+/*!
+    \class QtWayland::InputRegion
+    \internal
+
+    A region prepared for testing points against it, for hit-testing input
+    regions of surfaces.
+
+    QRegion::contains() walks the rectangles of the region one by one. This
+    keeps the region as horizontal bands sorted from top to bottom, each with
+    its spans sorted from left to right, and finds the band and the span by
+    binary search. It is built once per region and costs O(log n) per point.
+*/
+InputRegion::InputRegion()
+{
+}
+
+InputRegion::InputRegion(const QRegion &region)
+{
+    setRegion(region);
+}
+
+void InputRegion::setRegion(const QRegion &region)
+{
+    m_bounds = region.boundingRect();
+    m_bands.clear();
+    m_spans.clear();
+
+    // QRegion hands out its rectangles y-x banded: sorted by top, and the
+    // rectangles of one band share top and bottom and do not overlap
+    const QVector<QRect> rects = region.rects();
+    m_spans.reserve(rects.size());
+    foreach (const QRect &rect, rects) {
+        if (m_bands.isEmpty() || m_bands.last().top != rect.top()) {
+            // Inclusive ends, as one past the end overflows for a rectangle
+            // reaching INT_MAX, such as the default input region
+            const Band band = { rect.top(), rect.bottom(), m_spans.size(), 0 };
+            m_bands.append(band);
+        }
+        const Span span = { rect.left(), rect.right() };
+        m_spans.append(span);
+        ++m_bands.last().spanCount;
+    }
+}
+
+bool InputRegion::aboveBand(int y, const Band &band)
+{
+    return y < band.top;
+}
+
+bool InputRegion::leftOfSpan(int x, const Span &span)
+{
+    return x < span.left;
+}
+
+bool InputRegion::contains(const QPoint &point) const
+{
+    if (!m_bounds.contains(point))
+        return false;
+
+    const int y = point.y();
+    QVector<Band>::const_iterator band = std::upper_bound(m_bands.constBegin(), m_bands.constEnd(), y, aboveBand);
+    if (band == m_bands.constBegin())
+        return false;
+    --band;
+    if (y > band->bottom)
+        return false;
+
+    const int x = point.x();
+    const Span *first = m_spans.constData() + band->firstSpan;
+    const Span *last = first + band->spanCount;
+    const Span *span = std::upper_bound(first, last, x, leftOfSpan);
+    if (span == first)
+        return false;
+    --span;
+    return x <= span->right;
+}
+
+// A point belongs to the pixel it lies in
+bool InputRegion::contains(const QPointF &point) const
+{
+    return contains(QPoint(qFloor(point.x()), qFloor(point.y())));
+}
+
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,93 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the Qt Compositor.
+**
+** $QT_BEGIN_LICENSE:BSD$
+** You may use this file under the terms of the BSD license as follows:
+**
+** "Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are
+** met:
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in
+**     the documentation and/or other materials provided with the
+**     distribution.
+**   * Neither the name of The Qt Company Ltd nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QTWAYLAND_QWLINPUTREGION_P_H
+#define QTWAYLAND_QWLINPUTREGION_P_H
+
+#include <QtCompositor/qwaylandexport.h>
+
+#include <QtCore/QPoint>
+#include <QtCore/QRect>
+#include <QtCore/QVector>
+#include <QtGui/QRegion>
+
+QT_BEGIN_NAMESPACE
+
+namespace QtWayland {
+
+class Q_COMPOSITOR_EXPORT InputRegion
+{
+public:
+    InputRegion();
+    explicit InputRegion(const QRegion &region);
+
+    void setRegion(const QRegion &region);
+
+    bool isEmpty() const { return m_bands.isEmpty(); }
+    QRect boundingRect() const { return m_bounds; }
+
+    bool contains(const QPoint &point) const;
+    bool contains(const QPointF &point) const;
+
+private:
+    struct Band {
+        int top;
+        int bottom;
+        int firstSpan;
+        int spanCount;
+    };
+    struct Span {
+        int left;
+        int right;
+    };
+
+    static bool aboveBand(int y, const Band &band);
+    static bool leftOfSpan(int x, const Span &span);
+
+    QRect m_bounds;
+    QVector<Band> m_bands;
+    QVector<Span> m_spans;
+};
+
+}
+
+QT_END_NAMESPACE
+
+#endif // QTWAYLAND_QWLINPUTREGION_P_H
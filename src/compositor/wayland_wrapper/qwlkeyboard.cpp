@@ -45,7 +45,9 @@
 #include <QStandardPaths>
 
 #include "qwlcompositor_p.h"
+#include "qwlinputdevice_p.h"
 #include "qwlsurface_p.h"
+#include "../shared/qwaylandxkb.h"
 
 #include <fcntl.h>
 #include <unistd.h>
@@ -134,6 +136,7 @@ void Keyboard::focused(Surface *surface)
 
     m_focusResource = resource;
     m_focus = surface;
+    m_compositor->inputFocusChanged(m_seat->handle(), m_focus);
     Q_EMIT focusChanged(m_focus);
 }
 
@@ -180,6 +183,28 @@ void Keyboard::sendKeyReleaseEvent(uint code)
     sendKeyEvent(code, WL_KEYBOARD_KEY_STATE_RELEASED);
 }
 
+/*
+    Returns the keycode that produces the keysym matching \a key with the
+    current keymap, or 0 if there is none. This allows synthesizing key events
+    from Qt keys without going through an xkb state.
+*/
+uint Keyboard::keycodeForQtKey(int key, Qt::KeyboardModifiers modifiers)
+{
+#ifndef QT_NO_WAYLAND_XKB
+    if (!m_context)
+        return 0;
+
+    if (m_keycodes.isEmpty())
+        buildKeycodeTable();
+
+    return m_keycodes.value(QWaylandXkb::qtKeyToKeysym(key, modifiers));
+#else
+    Q_UNUSED(key);
+    Q_UNUSED(modifiers);
+    return 0;
+#endif
+}
+
 Surface *Keyboard::focus() const
 {
     return m_focus;
@@ -383,6 +408,7 @@ void Keyboard::createXKBKeymap()
     free(keymap_str);
 
     m_state = xkb_state_new(keymap);
+    m_keycodes.clear();
 
     xkb_keymap_unref(keymap);
 
@@ -392,6 +418,28 @@ void Keyboard::createXKBKeymap()
     free((char *)rule_names.variant);
     free((char *)rule_names.options);
 }
+
+void Keyboard::buildKeycodeTable()
+{
+    // Levels are walked in order so that the keycode producing a keysym
+    // without any modifier wins over the shifted ones.
+    struct xkb_keymap *keymap = xkb_state_get_keymap(m_state);
+    const xkb_keycode_t minCode = xkb_keymap_min_keycode(keymap);
+    const xkb_keycode_t maxCode = xkb_keymap_max_keycode(keymap);
+
+    xkb_level_index_t maxLevel = 0;
+    for (xkb_keycode_t code = minCode; code <= maxCode; ++code)
+        maxLevel = qMax(maxLevel, xkb_keymap_num_levels_for_key(keymap, code, 0));
+
+    for (xkb_level_index_t level = 0; level < maxLevel; ++level) {
+        for (xkb_keycode_t code = minCode; code <= maxCode; ++code) {
+            const xkb_keysym_t *syms;
+            if (xkb_keymap_key_get_syms_by_level(keymap, code, 0, level, &syms) == 1
+                    && !m_keycodes.contains(syms[0]))
+                m_keycodes.insert(syms[0], code);
+        }
+    }
+}
 #endif
 
 } // namespace QtWayland
@@ -48,6 +48,7 @@
 #include <QObject>
 #include <QtCompositor/private/qwayland-server-wayland.h>
 
+#include <QtCore/QHash>
 #include <QtCore/QVector>
 
 #ifndef QT_NO_WAYLAND_XKB
@@ -91,6 +92,8 @@ public:
     void sendKeyPressEvent(uint code);
     void sendKeyReleaseEvent(uint code);
 
+    uint keycodeForQtKey(int key, Qt::KeyboardModifiers modifiers);
+
     Surface *focus() const;
     Resource *focusResource() const;
 
@@ -127,6 +130,7 @@ private:
 #ifndef QT_NO_WAYLAND_XKB
     void initXKB();
     void createXKBKeymap();
+    void buildKeycodeTable();
 #endif
 
     Compositor *m_compositor;
@@ -151,6 +155,7 @@ private:
     char *m_keymap_area;
     struct xkb_context *m_context;
     struct xkb_state *m_state;
+    QHash<xkb_keysym_t, uint> m_keycodes;
 #endif
 };
 
@@ -169,6 +169,8 @@ void Output::setMode(const QWaylandOutput::Mode &mode)
         if (resource->version() >= 2)
             send_done(resource->handle);
     }
+
+    m_compositor->scheduleFlush();
 }
 
 QRect Output::geometry() const
@@ -196,6 +198,8 @@ void Output::setGeometry(const QRect &geometry)
         if (resource->version() >= 2)
             send_done(resource->handle);
     }
+
+    m_compositor->scheduleFlush();
 }
 
 void Output::setAvailableGeometry(const QRect &availableGeometry)
@@ -246,6 +250,8 @@ void Output::setScaleFactor(int scale)
             send_done(resource->handle);
         }
     }
+
+    m_compositor->scheduleFlush();
 }
 
 OutputResource *Output::outputForClient(wl_client *client) const
@@ -264,6 +270,8 @@ void Output::sendGeometryInfo()
         if (resource->version() >= 2)
             send_done(resource->handle);
     }
+
+    m_compositor->scheduleFlush();
 }
 
 } // namespace Wayland
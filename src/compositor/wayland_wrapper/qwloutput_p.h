@@ -46,6 +46,7 @@
 
 #include <QtCore/QRect>
 #include <QtCore/QList>
+#include <QtCore/QPointer>
 
 #include <QtCompositor/private/qwayland-server-wayland.h>
 #include <QtCompositor/qwaylandoutput.h>
@@ -53,6 +54,7 @@
 QT_BEGIN_NAMESPACE
 
 class QWindow;
+class QWaylandOutputCapture;
 
 namespace QtWayland {
 
@@ -108,6 +110,10 @@ public:
 
     QWaylandOutput *waylandOutput() const { return m_output; }
 
+    QList<QWaylandOutputCapture *> captures() const { return m_captures; }
+    void addCapture(QWaylandOutputCapture *capture) { m_captures.append(capture); }
+    void removeCapture(QWaylandOutputCapture *capture) { m_captures.removeOne(capture); }
+
     void output_bind_resource(Resource *resource) Q_DECL_OVERRIDE;
     Resource *output_allocate() Q_DECL_OVERRIDE { return new OutputResource; }
 
@@ -127,6 +133,13 @@ private:
     QWaylandOutput::Transform m_transform;
     int m_scaleFactor;
     QList<QWaylandSurface *> m_surfaces;
+    QList<QWaylandOutputCapture *> m_captures;
+
+    /* Cursor layer */
+    QPointer<QWaylandSurface> m_cursorSurface;
+    QPoint m_cursorHotspot;
+    QPoint m_cursorPosition;
+    QRect m_cursorRect;
 
     void sendGeometryInfo();
 };
@@ -46,6 +46,7 @@
 #include "qwlkeyboard_p.h"
 #include "qwlsurface_p.h"
 #include "qwaylandcompositor.h"
+#include "qwaylandoutput.h"
 #include "qwaylandsurfaceview.h"
 
 QT_BEGIN_NAMESPACE
@@ -128,6 +129,8 @@ void Pointer::setFocus(QWaylandSurfaceView *surface, const QPointF &position)
 
     m_focusResource = resource;
     m_focus = surface;
+    if (m_focus)
+        m_compositor->inputFocusChanged(m_seat->handle(), m_focus->surface()->handle());
 }
 
 void Pointer::focusDestroyed(void *data)
@@ -228,6 +231,7 @@ void Pointer::setMouseFocus(QWaylandSurfaceView *surface, const QPointF &localPo
 
     m_current = surface;
     m_currentPoint = localPos;
+    updateCursorPosition();
 
     m_grab->focus();
 }
@@ -270,10 +274,18 @@ void Pointer::sendMouseMoveEvent(const QPointF &localPos, const QPointF &globalP
 
     m_position = globalPos;
     m_currentPoint = localPos;
+    updateCursorPosition();
 
     m_grab->motion(time);
 }
 
+void Pointer::updateCursorPosition()
+{
+    // The cursor layer of every output follows the pointer
+    foreach (QWaylandOutput *output, m_compositor->outputs())
+        output->setCursorPosition(m_position.toPoint());
+}
+
 void Pointer::sendMouseWheelEvent(Qt::Orientation orientation, int delta)
 {
     if (!m_focusResource)
@@ -119,6 +119,7 @@ protected:
 
 private:
     void focusDestroyed(void *data);
+    void updateCursorPosition();
 
     Compositor *m_compositor;
     InputDevice *m_seat;
@@ -51,7 +51,7 @@ namespace QtWayland {
 static const int maxRawPos = 24;
 
 TouchExtensionGlobal::TouchExtensionGlobal(Compositor *compositor)
-    : QtWaylandServer::qt_touch_extension(compositor->wl_display(), 1)
+    : QtWaylandServer::qt_touch_extension(compositor->wl_display(), 2)
     , m_compositor(compositor)
     , m_flags(0)
     , m_resources()
@@ -85,6 +85,9 @@ bool TouchExtensionGlobal::postTouchEvent(QTouchEvent *event, QWaylandSurfaceVie
         if (target->client() != surfaceClient)
             continue;
 
+        if (target->version() >= 2)
+            return postTouchFrame(target, event, surfacePos, time);
+
         // We will use no touch_frame type of event, to reduce the number of
         // events flowing through the wire. Instead, the number of points sent is
         // included in the touch point events.
@@ -145,6 +148,115 @@ bool TouchExtensionGlobal::postTouchEvent(QTouchEvent *event, QWaylandSurfaceVie
     return false;
 }
 
+static inline void appendWord(QByteArray &data, uint32_t word)
+{
+    data.append(reinterpret_cast<const char *>(&word), sizeof(word));
+}
+
+/*
+    Sends all non-stationary points of the event in one touch_frame event.
+    Fields that did not change since the point was last sent are left out.
+*/
+bool TouchExtensionGlobal::postTouchFrame(Resource *target, QTouchEvent *event, const QPointF &surfacePos, uint32_t time)
+{
+    QHash<int, PackedPoint> &sentPoints = m_sentPoints[target];
+    const QList<QTouchEvent::TouchPoint> points = event->touchPoints();
+
+    m_frameData.resize(0);
+    for (int i = 0; i < points.count(); ++i) {
+        const QTouchEvent::TouchPoint &tp(points.at(i));
+        if (tp.state() == Qt::TouchPointStationary)
+            continue;
+
+        PackedPoint point;
+        QPointF p = tp.pos() - surfacePos; // surface-relative
+        point.x = toFixed(p.x());
+        point.y = toFixed(p.y());
+        point.nx = toFixed(tp.normalizedPos().x());
+        point.ny = toFixed(tp.normalizedPos().y());
+        point.w = toFixed(tp.rect().width());
+        point.h = toFixed(tp.rect().height());
+        point.pressure = uint32_t(tp.pressure() * 255);
+        point.vx = toFixed(tp.velocity().x());
+        point.vy = toFixed(tp.velocity().y());
+        point.rawPositions = tp.rawScreenPositions();
+        if (point.rawPositions.count() > maxRawPos)
+            point.rawPositions.resize(maxRawPos);
+
+        uint32_t fields = QT_TOUCH_EXTENSION_FRAME_FIELD_POSITION
+                | QT_TOUCH_EXTENSION_FRAME_FIELD_NORMALIZED_POSITION
+                | QT_TOUCH_EXTENSION_FRAME_FIELD_SIZE
+                | QT_TOUCH_EXTENSION_FRAME_FIELD_PRESSURE
+                | QT_TOUCH_EXTENSION_FRAME_FIELD_VELOCITY
+                | QT_TOUCH_EXTENSION_FRAME_FIELD_RAW_POSITIONS;
+        QHash<int, PackedPoint>::const_iterator previous = sentPoints.constFind(tp.id());
+        if (tp.state() != Qt::TouchPointPressed && previous != sentPoints.constEnd()) {
+            const PackedPoint &last = previous.value();
+            if (last.x == point.x && last.y == point.y)
+                fields &= ~QT_TOUCH_EXTENSION_FRAME_FIELD_POSITION;
+            if (last.nx == point.nx && last.ny == point.ny)
+                fields &= ~QT_TOUCH_EXTENSION_FRAME_FIELD_NORMALIZED_POSITION;
+            if (last.w == point.w && last.h == point.h)
+                fields &= ~QT_TOUCH_EXTENSION_FRAME_FIELD_SIZE;
+            if (last.pressure == point.pressure)
+                fields &= ~QT_TOUCH_EXTENSION_FRAME_FIELD_PRESSURE;
+            if (last.vx == point.vx && last.vy == point.vy)
+                fields &= ~QT_TOUCH_EXTENSION_FRAME_FIELD_VELOCITY;
+            if (last.rawPositions == point.rawPositions)
+                fields &= ~QT_TOUCH_EXTENSION_FRAME_FIELD_RAW_POSITIONS;
+        }
+
+        appendWord(m_frameData, tp.id());
+        appendWord(m_frameData, (tp.state() & 0xFF) | ((uint32_t(tp.flags()) & 0xFF) << 8) | (fields << 16));
+        if (fields & QT_TOUCH_EXTENSION_FRAME_FIELD_POSITION) {
+            appendWord(m_frameData, point.x);
+            appendWord(m_frameData, point.y);
+        }
+        if (fields & QT_TOUCH_EXTENSION_FRAME_FIELD_NORMALIZED_POSITION) {
+            appendWord(m_frameData, point.nx);
+            appendWord(m_frameData, point.ny);
+        }
+        if (fields & QT_TOUCH_EXTENSION_FRAME_FIELD_SIZE) {
+            appendWord(m_frameData, point.w);
+            appendWord(m_frameData, point.h);
+        }
+        if (fields & QT_TOUCH_EXTENSION_FRAME_FIELD_PRESSURE)
+            appendWord(m_frameData, point.pressure);
+        if (fields & QT_TOUCH_EXTENSION_FRAME_FIELD_VELOCITY) {
+            appendWord(m_frameData, point.vx);
+            appendWord(m_frameData, point.vy);
+        }
+        if (fields & QT_TOUCH_EXTENSION_FRAME_FIELD_RAW_POSITIONS) {
+            appendWord(m_frameData, point.rawPositions.count());
+            // This will stay in screen coordinates for performance reasons
+            foreach (const QPointF &rawPos, point.rawPositions) {
+                const float xy[2] = { static_cast<float>(rawPos.x()), static_cast<float>(rawPos.y()) };
+                m_frameData.append(reinterpret_cast<const char *>(xy), sizeof(xy));
+            }
+        }
+
+        if (tp.state() == Qt::TouchPointReleased)
+            sentPoints.remove(tp.id());
+        else
+            sentPoints.insert(tp.id(), point);
+    }
+
+    if (m_frameData.isEmpty())
+        return true;
+
+    send_touch_frame(target->handle, time, uint32_t(event->device()->capabilities()), m_frameData);
+    return true;
+}
+
+/*
+    Clients forget their touch points when the sequence is canceled, so
+    points sent afterwards carry all fields again.
+*/
+void TouchExtensionGlobal::touchCanceled()
+{
+    m_sentPoints.clear();
+}
+
 void TouchExtensionGlobal::touch_extension_bind_resource(Resource *resource)
 {
     m_resources.append(resource);
@@ -154,6 +266,7 @@ void TouchExtensionGlobal::touch_extension_bind_resource(Resource *resource)
 void TouchExtensionGlobal::touch_extension_destroy_resource(Resource *resource)
 {
     m_resources.removeOne(resource);
+    m_sentPoints.remove(resource);
 }
 
 }
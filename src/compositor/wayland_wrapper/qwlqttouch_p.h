@@ -45,6 +45,10 @@
 #include <QtCompositor/private/qwayland-server-touch-extension.h>
 #include "wayland-util.h"
 
+#include <QtCore/QHash>
+#include <QtCore/QPointF>
+#include <QtCore/QVector>
+
 QT_BEGIN_NAMESPACE
 
 class Compositor;
@@ -61,6 +65,7 @@ public:
     ~TouchExtensionGlobal();
 
     bool postTouchEvent(QTouchEvent *event, QWaylandSurfaceView *view);
+    void touchCanceled();
 
     void setFlags(int flags) { m_flags = flags; }
 
@@ -69,10 +74,24 @@ protected:
     void touch_extension_destroy_resource(Resource *resource) Q_DECL_OVERRIDE;
 
 private:
+    struct PackedPoint {
+        int x, y;
+        int nx, ny;
+        int w, h;
+        uint32_t pressure;
+        int vx, vy;
+        QVector<QPointF> rawPositions;
+    };
+
+    bool postTouchFrame(Resource *target, QTouchEvent *event, const QPointF &surfacePos, uint32_t time);
+
     Compositor *m_compositor;
     int m_flags;
     QList<Resource *> m_resources;
     QVector<float> m_posData;
+    // Last values sent for each touch point, per resource using touch frames
+    QHash<Resource *, QHash<int, PackedPoint> > m_sentPoints;
+    QByteArray m_frameData;
 };
 
 }
@@ -48,6 +48,7 @@ namespace QtWayland {
 
 Region::Region(struct wl_client *client, uint32_t id)
     : QtWaylandServer::wl_region(client, id, 1)
+    , m_region(DamageAccumulator::Exact)
 {
 }
 
@@ -72,12 +73,12 @@ void Region::region_destroy(Resource *resource)
 
 void Region::region_add(Resource *, int32_t x, int32_t y, int32_t w, int32_t h)
 {
-    m_region += QRect(x, y, w, h);
+    m_region.add(QRect(x, y, w, h));
 }
 
 void Region::region_subtract(Resource *, int32_t x, int32_t y, int32_t w, int32_t h)
 {
-    m_region -= QRect(x, y, w, h);
+    m_region.subtract(QRect(x, y, w, h));
 }
 
 }
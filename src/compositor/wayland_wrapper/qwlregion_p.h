@@ -45,6 +45,8 @@
 
 #include <QRegion>
 
+#include <QtCompositor/private/qwldamageaccumulator_p.h>
+
 #include <wayland-util.h>
 #include <QtCompositor/private/qwayland-server-wayland.h>
 
@@ -62,12 +64,12 @@ public:
 
     uint id() const { return resource()->handle->object.id; }
 
-    QRegion region() const { return m_region; }
+    QRegion region() const { return m_region.region(); }
 
 private:
     Q_DISABLE_COPY(Region)
 
-    QRegion m_region;
+    DamageAccumulator m_region;
 
     void region_destroy_resource(Resource *) Q_DECL_OVERRIDE;
 
@@ -49,6 +49,7 @@
 #include "qwlpointer_p.h"
 #include "qwlextendedsurface_p.h"
 
+#include "qwaylandclient.h"
 #include "qwaylandoutput.h"
 #include "qwaylandsurfaceview.h"
 
@@ -98,7 +99,14 @@ ShellSurface::ShellSurface(Shell *shell, wl_client *client, uint32_t id, Surface
     , m_moveGrabber(0)
     , m_popupGrabber(0)
     , m_popupSerial()
+    , m_configureInFlight(false)
+    , m_hasPendingConfigure(false)
+    , m_pendingEdges(0)
 {
+    m_configureTimer.setSingleShot(true);
+    m_configureTimer.setInterval(200);
+    connect(&m_configureTimer, &QTimer::timeout, this, &ShellSurface::configureTimedOut);
+
     m_view = surface->compositor()->waylandCompositor()->createView(surface->waylandSurface());
     connect(surface->waylandSurface(), &QWaylandSurface::configure, this, &ShellSurface::configure);
     connect(surface->waylandSurface(), &QWaylandSurface::mapped, this, &ShellSurface::mapped);
@@ -109,9 +117,42 @@ ShellSurface::~ShellSurface()
     delete m_view;
 }
 
+/*
+    Sends a configure event, keeping at most one of them in flight: while the
+    client has not committed a buffer in response to the previous one, only
+    the latest requested size is remembered. Until then the previous buffer
+    keeps being shown, scaled or cropped by the view to its new geometry.
+    Clients that never respond are unblocked after a timeout.
+*/
 void ShellSurface::sendConfigure(uint32_t edges, int32_t width, int32_t height)
 {
-    send_configure(edges, width, height);
+    m_pendingEdges = edges;
+    m_pendingSize = QSize(width, height);
+    m_hasPendingConfigure = true;
+
+    if (!m_configureInFlight)
+        flushConfigure();
+}
+
+void ShellSurface::flushConfigure()
+{
+    if (!m_hasPendingConfigure)
+        return;
+
+    m_hasPendingConfigure = false;
+    m_configureInFlight = true;
+    m_configureTimer.start();
+    send_configure(m_pendingEdges, m_pendingSize.width(), m_pendingSize.height());
+}
+
+void ShellSurface::configureTimedOut()
+{
+    m_configureInFlight = false;
+    flushConfigure();
+
+    // Sent from the timer, outside of request dispatch
+    if (QWaylandClient *client = m_surface->waylandSurface()->client())
+        m_surface->compositor()->scheduleFlush(client);
 }
 
 void ShellSurface::ping(uint32_t serial)
@@ -157,6 +198,13 @@ void ShellSurface::setOffset(const QPointF &offset)
 void ShellSurface::configure(bool hasBuffer)
 {
     m_surface->setMapped(hasBuffer);
+
+    // A new buffer answers the configure in flight, send the next size if any
+    if (m_configureInFlight) {
+        m_configureInFlight = false;
+        m_configureTimer.stop();
+        flushConfigure();
+    }
 }
 
 bool ShellSurface::runOperation(QWaylandSurfaceOp *op)
@@ -188,7 +236,7 @@ void ShellSurface::mapped()
 
 void ShellSurface::requestSize(const QSize &size)
 {
-    send_configure(WL_SHELL_SURFACE_RESIZE_BOTTOM_RIGHT, size.width(), size.height());
+    sendConfigure(WL_SHELL_SURFACE_RESIZE_BOTTOM_RIGHT, size.width(), size.height());
 }
 
 void ShellSurface::shell_surface_destroy_resource(Resource *)
@@ -306,7 +354,8 @@ void ShellSurface::shell_surface_set_fullscreen(Resource *resource,
     QSize outputSize = output->geometry().size();
 
     m_view->setPos(output->geometry().topLeft());
-    send_configure(resize_bottom_right, outputSize.width(), outputSize.height());
+    // Replaces any size still waiting to be sent
+    sendConfigure(resize_bottom_right, outputSize.width(), outputSize.height());
 
     m_surface->setVisibility(QWindow::FullScreen);
 }
@@ -354,7 +403,7 @@ void ShellSurface::shell_surface_set_maximized(Resource *resource,
     QSize outputSize = output->availableGeometry().size();
 
     m_view->setPos(output->availableGeometry().topLeft());
-    send_configure(resize_bottom_right, outputSize.width(), outputSize.height());
+    sendConfigure(resize_bottom_right, outputSize.width(), outputSize.height());
 
     m_surface->setVisibility(QWindow::Maximized);
 }
@@ -362,11 +411,13 @@ void ShellSurface::shell_surface_set_maximized(Resource *resource,
 void ShellSurface::shell_surface_pong(Resource *resource,
                         uint32_t serial)
 {
-    Q_UNUSED(resource);
-    if (m_pings.remove(serial))
-        emit m_surface->waylandSurface()->pong();
-    else
+    if (m_pings.remove(serial)) {
+        // Only pings sent through QWaylandSurface::ping() are reported
+        if (!m_surface->compositor()->handlePong(resource->client(), serial))
+            emit m_surface->waylandSurface()->pong();
+    } else {
         qWarning("Received an unexpected pong!");
+    }
 }
 
 void ShellSurface::shell_surface_set_title(Resource *resource,
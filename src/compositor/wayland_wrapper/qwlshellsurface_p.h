@@ -50,6 +50,7 @@
 #include <QHash>
 #include <QPoint>
 #include <QSet>
+#include <QTimer>
 #include <private/qwlpointer_p.h>
 
 #include <QtCompositor/private/qwayland-server-wayland.h>
@@ -107,6 +108,7 @@ protected:
 
 private Q_SLOTS:
     void mapped();
+    void configureTimedOut();
 
 private:
     Shell *m_shell;
@@ -121,6 +123,14 @@ private:
 
     QSet<uint32_t> m_pings;
 
+    bool m_configureInFlight;
+    bool m_hasPendingConfigure;
+    uint32_t m_pendingEdges;
+    QSize m_pendingSize;
+    QTimer m_configureTimer;
+
+    void flushConfigure();
+
     void shell_surface_destroy_resource(Resource *resource) Q_DECL_OVERRIDE;
 
     void shell_surface_move(Resource *resource,
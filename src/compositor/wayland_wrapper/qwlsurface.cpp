@@ -63,27 +63,14 @@ namespace QtWayland {
 
 class FrameCallback {
 public:
-    FrameCallback(Surface *surf, wl_resource *res)
-        : surface(surf)
-        , resource(res)
-        , canSend(false)
-    {
-#if WAYLAND_VERSION_MAJOR < 1 || (WAYLAND_VERSION_MAJOR == 1 && WAYLAND_VERSION_MINOR <= 2)
-        res->data = this;
-        res->destroy = destroyCallback;
-#else
-        wl_resource_set_implementation(res, 0, this, destroyCallback);
-#endif
-    }
-    ~FrameCallback()
-    {
-    }
+    static FrameCallback *create(Surface *surf, wl_resource *res);
+
     void destroy()
     {
         if (resource)
             wl_resource_destroy(resource);
         else
-            delete this;
+            release();
     }
     void send(uint time)
     {
@@ -98,13 +85,69 @@ public:
         FrameCallback *_this = static_cast<FrameCallback *>(wl_resource_get_user_data(res));
 #endif
         _this->surface->removeFrameCallback(_this);
-        delete _this;
+        _this->release();
     }
     Surface *surface;
     wl_resource *resource;
-    bool canSend;
+    // Links the callback into one of the surface's callback lists, or into
+    // the pool once released
+    wl_list link;
+
+private:
+    FrameCallback() {}
+    void release();
 };
 
+// Clients requesting a callback with every commit allocate and free one per
+// frame, so released callbacks are kept around for reuse
+static const int maxPooledFrameCallbacks = 64;
+static wl_list frameCallbackPool = { &frameCallbackPool, &frameCallbackPool };
+static int frameCallbackPoolSize = 0;
+
+FrameCallback *FrameCallback::create(Surface *surf, wl_resource *res)
+{
+    FrameCallback *callback;
+    if (wl_list_empty(&frameCallbackPool)) {
+        callback = new FrameCallback;
+    } else {
+        callback = wl_container_of(frameCallbackPool.next, (FrameCallback *)0, link);
+        wl_list_remove(&callback->link);
+        --frameCallbackPoolSize;
+    }
+    callback->surface = surf;
+    callback->resource = res;
+    wl_list_init(&callback->link);
+#if WAYLAND_VERSION_MAJOR < 1 || (WAYLAND_VERSION_MAJOR == 1 && WAYLAND_VERSION_MINOR <= 2)
+    res->data = callback;
+    res->destroy = destroyCallback;
+#else
+    wl_resource_set_implementation(res, 0, callback, destroyCallback);
+#endif
+    return callback;
+}
+
+void FrameCallback::release()
+{
+    if (frameCallbackPoolSize < maxPooledFrameCallbacks) {
+        wl_list_insert(&frameCallbackPool, &link);
+        ++frameCallbackPoolSize;
+    } else {
+        delete this;
+    }
+}
+
+// Callbacks a surface may have waiting for one frame. A client committing
+// more often than frames are shown gets the oldest ones completed right
+// away, as the commits they were requested for have already been superseded.
+static const int maxFrameCallbacks = 8;
+
+static void destroyFrameCallbacks(wl_list *list)
+{
+    FrameCallback *callback, *next;
+    wl_list_for_each_safe(callback, next, list, link)
+        callback->destroy();
+}
+
 static QRegion infiniteRegion() {
     return QRegion(QRect(QPoint(std::numeric_limits<int>::min(), std::numeric_limits<int>::min()),
                          QPoint(std::numeric_limits<int>::max(), std::numeric_limits<int>::max())));
@@ -122,6 +165,7 @@ Surface::Surface(struct wl_client *client, uint32_t id, int version, QWaylandCom
     , m_subSurface(0)
     , m_inputPanelSurface(0)
     , m_inputRegion(infiniteRegion())
+    , m_inputHitTest(m_inputRegion)
     , m_transientParent(0)
     , m_transientInactive(false)
     , m_transientOffset(QPointF(0, 0))
@@ -135,6 +179,10 @@ Surface::Surface(struct wl_client *client, uint32_t id, int version, QWaylandCom
     m_pending.buffer = 0;
     m_pending.newlyAttached = false;
     m_pending.inputRegion = infiniteRegion();
+
+    wl_list_init(&m_pendingFrameCallbacks);
+    wl_list_init(&m_frameCallbacks);
+    wl_list_init(&m_sendFrameCallbacks);
 }
 
 Surface::~Surface()
@@ -146,10 +194,9 @@ Surface::~Surface()
     for (int i = 0; i < m_bufferPool.size(); i++)
         m_bufferPool[i]->setDestroyIfUnused(true);
 
-    foreach (FrameCallback *c, m_pendingFrameCallbacks)
-        c->destroy();
-    foreach (FrameCallback *c, m_frameCallbacks)
-        c->destroy();
+    destroyFrameCallbacks(&m_pendingFrameCallbacks);
+    destroyFrameCallbacks(&m_frameCallbacks);
+    destroyFrameCallbacks(&m_sendFrameCallbacks);
 }
 
 bool Surface::setRole(const SurfaceRole *role, wl_resource *errorResource, uint32_t errorCode)
@@ -230,18 +277,15 @@ QRegion Surface::opaqueRegion() const
 void Surface::sendFrameCallback()
 {
     uint time = m_compositor->currentTimeMsecs();
-    foreach (FrameCallback *callback, m_frameCallbacks) {
-        if (callback->canSend) {
-            callback->send(time);
-            m_frameCallbacks.removeOne(callback);
-        }
-    }
+    FrameCallback *callback, *next;
+    wl_list_for_each_safe(callback, next, &m_sendFrameCallbacks, link)
+        callback->send(time);
 }
 
 void Surface::removeFrameCallback(FrameCallback *callback)
 {
-    m_pendingFrameCallbacks.removeOne(callback);
-    m_frameCallbacks.removeOne(callback);
+    wl_list_remove(&callback->link);
+    wl_list_init(&callback->link);
 }
 
 QWaylandSurface * Surface::waylandSurface() const
@@ -323,6 +367,7 @@ void Surface::addToOutput(Output *output)
 
     QWaylandSurfaceEnterEvent event(output->waylandOutput());
     QCoreApplication::sendEvent(waylandSurface(), &event);
+    emit output->waylandOutput()->surfaceEntered(waylandSurface());
 
     // Send surface enter event
     Q_FOREACH (Resource *resource, resourceMap().values()) {
@@ -344,6 +389,7 @@ void Surface::removeFromOutput(Output *output)
 
     QWaylandSurfaceLeaveEvent event(output->waylandOutput());
     QCoreApplication::sendEvent(waylandSurface(), &event);
+    emit output->waylandOutput()->surfaceLeft(waylandSurface());
 
     // Send surface leave event
     Q_FOREACH (Resource *resource, resourceMap().values()) {
@@ -370,6 +416,8 @@ void Surface::setBackBuffer(SurfaceBuffer *buffer)
             setSize(m_buffer->size());
 
         m_damage = m_damage.intersected(QRect(QPoint(), m_size));
+        if (valid && m_compositor->earlyShmBufferReleaseEnabled() && m_buffer->isShmBuffer())
+            retainShmContent();
         emit m_waylandSurface->damaged(m_damage);
     } else {
         m_compositor->resetInputDevice(this);
@@ -377,6 +425,34 @@ void Surface::setBackBuffer(SurfaceBuffer *buffer)
     m_damage = QRegion();
 }
 
+/*
+    Copies the damaged parts of the SHM buffer into m_shmContent and hands the
+    buffer back to the client. The parts outside of the damage still hold the
+    contents of the previous buffers, as the protocol requires. Only while
+    someone else still holds a reference to the previous buffer is the whole
+    content copied first.
+*/
+void Surface::retainShmContent()
+{
+    const QImage image = m_buffer->image();
+    if (image.isNull())
+        return;
+
+    if (m_shmContent.size() != image.size() || m_shmContent.format() != image.format()) {
+        m_shmContent = image.copy();
+    } else {
+        const int bytesPerPixel = image.depth() / 8;
+        foreach (const QRect &rect, m_damage.rects()) {
+            const int offset = rect.x() * bytesPerPixel;
+            const int length = rect.width() * bytesPerPixel;
+            for (int y = rect.top(); y <= rect.bottom(); ++y)
+                memcpy(m_shmContent.scanLine(y) + offset, image.constScanLine(y) + offset, length);
+        }
+    }
+
+    m_buffer->releaseContent(m_shmContent);
+}
+
 void Surface::setMapped(bool mapped)
 {
     if (!m_surfaceMapped && mapped) {
@@ -457,13 +533,14 @@ void Surface::surface_attach(Resource *, struct wl_resource *buffer, int x, int
 
 void Surface::surface_damage(Resource *, int32_t x, int32_t y, int32_t width, int32_t height)
 {
-    m_pending.damage = m_pending.damage.united(QRect(x, y, width, height));
+    m_pending.damage.add(QRect(x, y, width, height));
 }
 
 void Surface::surface_frame(Resource *resource, uint32_t callback)
 {
     struct wl_resource *frame_callback = wl_resource_create(resource->client(), &wl_callback_interface, wl_callback_interface.version, callback);
-    m_pendingFrameCallbacks << new FrameCallback(this, frame_callback);
+    FrameCallback *frameCallback = FrameCallback::create(this, frame_callback);
+    wl_list_insert(m_pendingFrameCallbacks.prev, &frameCallback->link);
 }
 
 void Surface::surface_set_opaque_region(Resource *, struct wl_resource *region)
@@ -482,9 +559,12 @@ void Surface::surface_set_input_region(Resource *, struct wl_resource *region)
 
 void Surface::surface_commit(Resource *)
 {
-    m_damage = m_pending.damage;
+    m_damage = m_pending.damage.region();
 
     if (m_pending.buffer || m_pending.newlyAttached) {
+        // The previous buffer shares the retained SHM content, which would be
+        // copied as a whole by the next write as long as it is referenced
+        m_bufferRef = QWaylandBufferRef();
         setBackBuffer(m_pending.buffer);
         m_bufferRef = QWaylandBufferRef(m_buffer);
 
@@ -504,15 +584,29 @@ void Surface::surface_commit(Resource *)
     m_pending.buffer = 0;
     m_pending.offset = QPoint();
     m_pending.newlyAttached = false;
-    m_pending.damage = QRegion();
+    m_pending.damage.clear();
 
     if (m_buffer)
         m_buffer->setCommitted();
 
-    m_frameCallbacks << m_pendingFrameCallbacks;
-    m_pendingFrameCallbacks.clear();
+    if (!wl_list_empty(&m_pendingFrameCallbacks)) {
+        wl_list_insert_list(m_frameCallbacks.prev, &m_pendingFrameCallbacks);
+        wl_list_init(&m_pendingFrameCallbacks);
 
-    m_inputRegion = m_pending.inputRegion.intersected(QRect(QPoint(), m_size));
+        int excess = wl_list_length(&m_frameCallbacks) - maxFrameCallbacks;
+        if (excess > 0) {
+            uint time = m_compositor->currentTimeMsecs();
+            while (excess-- > 0)
+                wl_container_of(m_frameCallbacks.next, (FrameCallback *)0, link)->send(time);
+        }
+    }
+
+    // The hit-test structure is only rebuilt when the input region changes
+    const QRegion inputRegion = m_pending.inputRegion.intersected(QRect(QPoint(), m_size));
+    if (inputRegion != m_inputRegion) {
+        m_inputRegion = inputRegion;
+        m_inputHitTest.setRegion(m_inputRegion);
+    }
 
     emit m_waylandSurface->redraw();
 }
@@ -542,8 +636,11 @@ void Surface::surface_set_buffer_transform(Resource *resource, int32_t orientati
 
 void Surface::frameStarted()
 {
-    foreach (FrameCallback *c, m_frameCallbacks)
-        c->canSend = true;
+    if (wl_list_empty(&m_frameCallbacks))
+        return;
+
+    wl_list_insert_list(m_sendFrameCallbacks.prev, &m_frameCallbacks);
+    wl_list_init(&m_frameCallbacks);
 }
 
 void Surface::setClassName(const QString &className)
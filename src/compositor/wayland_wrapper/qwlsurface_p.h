@@ -45,6 +45,8 @@
 
 #include <private/qwlsurfacebuffer_p.h>
 #include <private/qwloutput_p.h>
+#include <private/qwldamageaccumulator_p.h>
+#include <private/qwlinputregion_p.h>
 #include <QtCompositor/qwaylandsurface.h>
 #include <QtCompositor/qwaylandbufferref.h>
 
@@ -103,8 +105,11 @@ public:
     void setSize(const QSize &size);
 
     QRegion inputRegion() const;
+    bool inputRegionContains(const QPointF &point) const { return m_inputHitTest.contains(point); }
     QRegion opaqueRegion() const;
 
+    QWaylandBufferRef currentBuffer() const { return m_bufferRef; }
+
     void sendFrameCallback();
     void removeFrameCallback(FrameCallback *callback);
 
@@ -188,13 +193,14 @@ protected:
     QRegion m_damage;
     SurfaceBuffer *m_buffer;
     QWaylandBufferRef m_bufferRef;
+    QImage m_shmContent;
     bool m_surfaceMapped;
     QWaylandBufferAttacher *m_attacher;
     QVector<QWaylandUnmapLock *> m_unmapLocks;
 
     struct {
         SurfaceBuffer *buffer;
-        QRegion damage;
+        DamageAccumulator damage;
         QPoint offset;
         bool newlyAttached;
         QRegion inputRegion;
@@ -203,14 +209,18 @@ protected:
     QPoint m_lastLocalMousePos;
     QPoint m_lastGlobalMousePos;
 
-    QList<FrameCallback *> m_pendingFrameCallbacks;
-    QList<FrameCallback *> m_frameCallbacks;
+    // Intrusive lists of FrameCallback: requested since the last commit,
+    // committed but waiting for a frame to start, and due to be sent
+    wl_list m_pendingFrameCallbacks;
+    wl_list m_frameCallbacks;
+    wl_list m_sendFrameCallbacks;
 
     ExtendedSurface *m_extendedSurface;
     SubSurface *m_subSurface;
     InputPanelSurface *m_inputPanelSurface;
 
     QRegion m_inputRegion;
+    InputRegion m_inputHitTest;
     QRegion m_opaqueRegion;
 
     QVector<SurfaceBuffer *> m_bufferPool;
@@ -230,6 +240,7 @@ protected:
     RoleBase *m_roleHandler;
 
     void setBackBuffer(SurfaceBuffer *buffer);
+    void retainShmContent();
     SurfaceBuffer *createSurfaceBuffer(struct ::wl_resource *buffer);
 
     friend class QWaylandSurface;
@@ -65,6 +65,7 @@ SurfaceBuffer::SurfaceBuffer(Surface *surface)
     , m_is_registered_for_buffer(false)
     , m_surface_has_buffer(false)
     , m_destroyed(false)
+    , m_released(false)
     , m_is_displayed(false)
     , m_texture(0)
     , m_is_shm_resolved(false)
@@ -92,6 +93,7 @@ void SurfaceBuffer::initialize(struct ::wl_resource *buffer)
     m_surface_has_buffer = true;
     m_is_displayed = false;
     m_destroyed = false;
+    m_released = false;
     m_handle = 0;
     m_is_shm_resolved = false;
     m_shmBuffer = 0;
@@ -126,6 +128,7 @@ void SurfaceBuffer::destructBufferState()
     m_committed = false;
     m_is_registered_for_buffer = false;
     m_is_displayed = false;
+    m_released = false;
     m_image = QImage();
 }
 
@@ -134,6 +137,7 @@ QSize SurfaceBuffer::size() const
     if (!m_isSizeResolved) {
         if (isShmBuffer()) {
             m_size = QSize(wl_shm_buffer_get_width(m_shmBuffer), wl_shm_buffer_get_height(m_shmBuffer));
+            m_isSizeResolved = true;
 #ifdef QT_COMPOSITOR_WAYLAND_GL
         } else {
             ClientBufferIntegration *hwIntegration = m_compositor->clientBufferIntegration();
@@ -162,9 +166,30 @@ bool SurfaceBuffer::isShmBuffer() const
 void SurfaceBuffer::sendRelease()
 {
     Q_ASSERT(m_buffer);
+    if (m_released)
+        return;
+    m_released = true;
     wl_buffer_send_release(m_buffer);
 }
 
+/*
+    Releases the buffer to the client before the last reference to it is gone.
+    From now on image() returns \a content, which must be a copy of the buffer
+    pixels; the client may already be drawing into the buffer again.
+*/
+void SurfaceBuffer::releaseContent(const QImage &content)
+{
+    if (!m_buffer || m_released)
+        return;
+
+    m_image = content;
+    if (m_handle) {
+        delete static_cast<QImage *>(m_handle);
+        m_handle = 0;
+    }
+    sendRelease();
+}
+
 void SurfaceBuffer::disown()
 {
     m_surface_has_buffer = false;
@@ -214,7 +239,8 @@ void *SurfaceBuffer::handle() const
             int stride = wl_shm_buffer_get_stride(m_shmBuffer);
             int width = wl_shm_buffer_get_width(m_shmBuffer);
             int height = wl_shm_buffer_get_height(m_shmBuffer);
-            QImage *image = new QImage(data,width,height,stride, QImage::Format_ARGB32_Premultiplied);
+            QImage *image = m_released ? new QImage(m_image)
+                                       : new QImage(data,width,height,stride, QImage::Format_ARGB32_Premultiplied);
             that->m_handle = image;
 #ifdef QT_COMPOSITOR_WAYLAND_GL
         } else {
@@ -229,6 +255,9 @@ void *SurfaceBuffer::handle() const
 QImage SurfaceBuffer::image()
 {
     /* This api may be available on non-shm buffer. But be sure about it's format. */
+    if (m_released)
+        return m_image;
+
     if (!m_buffer || !isShmBuffer())
         return QImage();
 
@@ -82,6 +82,8 @@ public:
     inline bool isRegisteredWithBuffer() const { return m_is_registered_for_buffer; }
 
     void sendRelease();
+    void releaseContent(const QImage &content);
+    inline bool isReleased() const { return m_released; }
     void disown();
 
     void setDisplayed();
@@ -126,6 +128,7 @@ private:
     bool m_is_registered_for_buffer;
     bool m_surface_has_buffer;
     bool m_destroyed;
+    bool m_released;
 
     bool m_is_displayed;
 #ifdef QT_COMPOSITOR_WAYLAND_GL
@@ -59,6 +59,9 @@ TextInput::TextInput(Compositor *compositor, struct ::wl_client *client, int id)
     , m_focus()
     , m_inputPanelVisible()
     , m_cursorRectangle()
+    , m_surroundingCursor(0)
+    , m_surroundingAnchor(0)
+    , m_surroundingTextValid(false)
 {
 }
 
@@ -86,6 +89,16 @@ void TextInput::deactivate(InputMethod *inputMethod)
         send_leave();
 }
 
+/*
+    Sends the last surrounding text of the client to \a context, used when an
+    input method gets activated for a text input that already sent its state.
+*/
+void TextInput::sendSurroundingText(InputMethodContext *context) const
+{
+    if (m_surroundingTextValid)
+        context->send_surrounding_text(m_surroundingText, m_surroundingCursor, m_surroundingAnchor);
+}
+
 void TextInput::text_input_destroy_resource(Resource *)
 {
     Q_FOREACH (InputMethod *inputMethod, m_activeInputMethods) {
@@ -154,6 +167,8 @@ void TextInput::text_input_set_cursor_rectangle(Resource *, int32_t x, int32_t y
 
 void TextInput::text_input_reset(Resource *)
 {
+    m_surroundingTextValid = false;
+
     Q_FOREACH (InputMethod *inputMethod, m_activeInputMethods) {
         if (inputMethod->context())
             inputMethod->context()->send_reset();
@@ -186,6 +201,16 @@ void TextInput::text_input_set_preferred_language(Resource *, const QString &lan
 
 void TextInput::text_input_set_surrounding_text(Resource *, const QString &text, uint32_t cursor, uint32_t anchor)
 {
+    // The input methods already know this state
+    if (m_surroundingTextValid && cursor == m_surroundingCursor && anchor == m_surroundingAnchor
+            && text == m_surroundingText)
+        return;
+
+    m_surroundingText = text;
+    m_surroundingCursor = cursor;
+    m_surroundingAnchor = anchor;
+    m_surroundingTextValid = true;
+
     Q_FOREACH (InputMethod *inputMethod, m_activeInputMethods) {
         if (inputMethod->context())
             inputMethod->context()->send_surrounding_text(text, cursor, anchor);
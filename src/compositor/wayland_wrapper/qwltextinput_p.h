@@ -51,6 +51,7 @@ namespace QtWayland {
 
 class Compositor;
 class InputMethod;
+class InputMethodContext;
 class Surface;
 
 class TextInput : public QtWaylandServer::wl_text_input
@@ -65,6 +66,8 @@ public:
 
     void deactivate(InputMethod *inputMethod);
 
+    void sendSurroundingText(InputMethodContext *context) const;
+
 protected:
     void text_input_destroy_resource(Resource *resource) Q_DECL_OVERRIDE;
 
@@ -88,6 +91,11 @@ private:
     bool m_inputPanelVisible;
     QRect m_cursorRectangle;
 
+    QString m_surroundingText;
+    uint32_t m_surroundingCursor;
+    uint32_t m_surroundingAnchor;
+    bool m_surroundingTextValid;
+
 };
 
 } // namespace QtWayland
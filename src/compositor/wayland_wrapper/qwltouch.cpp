@@ -70,6 +70,11 @@ void Touch::setFocus(QWaylandSurfaceView *surface)
     m_focusResource = surface ? resourceMap().value(surface->surface()->handle()->resource()->client()) : 0;
 }
 
+QWaylandSurfaceView *Touch::focusSurface() const
+{
+    return m_focus;
+}
+
 void Touch::startGrab(TouchGrabber *grab)
 {
     m_grab = grab;
@@ -84,6 +84,7 @@ public:
     explicit Touch(Compositor *compositor);
 
     void setFocus(QWaylandSurfaceView *surface);
+    QWaylandSurfaceView *focusSurface() const;
 
     void startGrab(TouchGrabber *grab);
     void endGrab();
@@ -11,6 +11,7 @@ WAYLANDSERVERSOURCES += \
 
 HEADERS += \
     wayland_wrapper/qwlcompositor_p.h \
+    wayland_wrapper/qwldamageaccumulator_p.h \
     wayland_wrapper/qwldatadevice_p.h \
     wayland_wrapper/qwldatadevicemanager_p.h \
     wayland_wrapper/qwldataoffer_p.h \
@@ -18,6 +19,7 @@ HEADERS += \
     wayland_wrapper/qwldisplay_p.h \
     wayland_wrapper/qwlextendedsurface_p.h \
     wayland_wrapper/qwlinputdevice_p.h \
+    wayland_wrapper/qwlinputregion_p.h \
     wayland_wrapper/qwlinputmethod_p.h \
     wayland_wrapper/qwlinputmethodcontext_p.h \
     wayland_wrapper/qwlinputpanel_p.h \
@@ -37,9 +39,11 @@ HEADERS += \
     wayland_wrapper/qwltouch_p.h \
     wayland_wrapper/qwllistener_p.h \
     ../shared/qwaylandxkb.h \
+    ../shared/qwaylandpropertycodec.h \
 
 SOURCES += \
     wayland_wrapper/qwlcompositor.cpp \
+    wayland_wrapper/qwldamageaccumulator.cpp \
     wayland_wrapper/qwldatadevice.cpp \
     wayland_wrapper/qwldatadevicemanager.cpp \
     wayland_wrapper/qwldataoffer.cpp \
@@ -47,6 +51,7 @@ SOURCES += \
     wayland_wrapper/qwldisplay.cpp \
     wayland_wrapper/qwlextendedsurface.cpp \
     wayland_wrapper/qwlinputdevice.cpp \
+    wayland_wrapper/qwlinputregion.cpp \
     wayland_wrapper/qwlinputmethod.cpp \
     wayland_wrapper/qwlinputmethodcontext.cpp \
     wayland_wrapper/qwlinputpanel.cpp \
@@ -66,6 +71,7 @@ SOURCES += \
     wayland_wrapper/qwltouch.cpp \
     wayland_wrapper/qwllistener.cpp \
     ../shared/qwaylandxkb.cpp \
+    ../shared/qwaylandpropertycodec.cpp \
 
 INCLUDEPATH += wayland_wrapper
 
@@ -55,6 +55,8 @@ QWaylandEglWindow::QWaylandEglWindow(QWindow *window)
     , m_eglSurface(0)
     , m_contentFBO(0)
     , m_resize(false)
+    , m_frameCount(0)
+    , m_decorationFrame(0)
 {
     QSurfaceFormat fmt = window->requestedFormat();
     if (mDisplay->supportsWindowDecoration())
@@ -98,9 +100,7 @@ void QWaylandEglWindow::setGeometry(const QRect &rect)
 
 void QWaylandEglWindow::updateSurface(bool create)
 {
-    QMargins margins = frameMargins();
-    QRect rect = geometry();
-    QSize sizeWithMargins = (rect.size() + QSize(margins.left() + margins.right(), margins.top() + margins.bottom())) * scale();
+    QSize sizeWithMargins = bufferSize();
 
     // wl_egl_windows must have both width and height > 0
     // mesa's egl returns NULL if we try to create a, invalid wl_egl_window, however not all EGL
@@ -137,6 +137,54 @@ void QWaylandEglWindow::updateSurface(bool create)
     }
 }
 
+QSize QWaylandEglWindow::bufferSize() const
+{
+    QMargins margins = frameMargins();
+    return (geometry().size() + QSize(margins.left() + margins.right(), margins.top() + margins.bottom())) * scale();
+}
+
+static const int maxDamageHistory = 4;
+
+void QWaylandEglWindow::frameSwapped(const QSize &bufferSize, const QRegion &damage)
+{
+    ++m_frameCount;
+    if (bufferSize != m_swappedSize)
+        m_damageHistory.clear();
+    m_swappedSize = bufferSize;
+
+    // No damage from the application means all of it changed
+    m_damageHistory.prepend(damage.isEmpty() ? QRegion(QRect(QPoint(), geometry().size())) : damage);
+    if (m_damageHistory.size() > maxDamageHistory)
+        m_damageHistory.removeLast();
+}
+
+// The bounding rectangle of the content that changed since the frame a back
+// buffer of the given age shows, in window coordinates
+QRect QWaylandEglWindow::contentDamageSince(int bufferAge, const QRegion &damage) const
+{
+    const QRect contentRect(QPoint(), geometry().size());
+    if (damage.isEmpty() || bufferAge <= 0 || bufferAge - 1 > m_damageHistory.size()
+            || bufferSize() != m_swappedSize)
+        return contentRect;
+
+    QRegion region = damage;
+    for (int i = 0; i < bufferAge - 1; ++i)
+        region += m_damageHistory.at(i);
+    return region.boundingRect() & contentRect;
+}
+
+// A back buffer holds the frame swapped bufferAge frames ago, so it shows the
+// current decoration if that has not changed since
+bool QWaylandEglWindow::decorationUpToDate(int bufferAge) const
+{
+    return bufferAge > 0 && uint(bufferAge) <= m_frameCount - m_decorationFrame;
+}
+
+void QWaylandEglWindow::markDecorationChanged()
+{
+    m_decorationFrame = m_frameCount;
+}
+
 QRect QWaylandEglWindow::contentsRect() const
 {
     QRect r = geometry();
@@ -168,11 +216,26 @@ GLuint QWaylandEglWindow::contentFBO() const
         return 0;
 
     if (m_resize || !m_contentFBO) {
-        QOpenGLFramebufferObject *old = m_contentFBO;
-        QSize fboSize = geometry().size() * scale();
-        m_contentFBO = new QOpenGLFramebufferObject(fboSize.width(), fboSize.height(), QOpenGLFramebufferObject::CombinedDepthStencil);
+        const QSize size = geometry().size() * scale();
+        QSize fboSize = size;
+        if (m_contentFBO) {
+            // Keep the framebuffer while the content fits and uses a fair part
+            // of it, so that an interactive resize does not recreate it on
+            // every step. When growing, leave some headroom.
+            const QSize current = m_contentFBO->size();
+            const bool fits = size.width() <= current.width() && size.height() <= current.height()
+                    && size.width() * size.height() * 4 >= current.width() * current.height();
+            if (fits)
+                fboSize = current;
+            else
+                fboSize = QSize((size.width() * 5 / 4 + 63) & ~63, (size.height() * 5 / 4 + 63) & ~63);
+        }
 
-        delete old;
+        if (!m_contentFBO || fboSize != m_contentFBO->size()) {
+            QOpenGLFramebufferObject *old = m_contentFBO;
+            m_contentFBO = new QOpenGLFramebufferObject(fboSize.width(), fboSize.height(), QOpenGLFramebufferObject::CombinedDepthStencil);
+            delete old;
+        }
         m_resize = false;
     }
 
@@ -184,6 +247,11 @@ GLuint QWaylandEglWindow::contentTexture() const
     return m_contentFBO->texture();
 }
 
+QSize QWaylandEglWindow::contentFBOSize() const
+{
+    return m_contentFBO->size();
+}
+
 void QWaylandEglWindow::bindContentFBO()
 {
     if (decoration()) {
@@ -60,6 +60,7 @@ public:
     EGLSurface eglSurface() const;
     GLuint contentFBO() const;
     GLuint contentTexture() const;
+    QSize contentFBOSize() const;
 
     QSurfaceFormat format() const;
 
@@ -67,6 +68,14 @@ public:
 
     void invalidateSurface() Q_DECL_OVERRIDE;
 
+    QSize bufferSize() const;
+    QSize swappedSize() const { return m_swappedSize; }
+    void frameSwapped(const QSize &bufferSize, const QRegion &damage);
+    QRect contentDamageSince(int bufferAge, const QRegion &damage) const;
+
+    bool decorationUpToDate(int bufferAge) const;
+    void markDecorationChanged();
+
 private:
     QWaylandEglClientBufferIntegration *m_clientBufferIntegration;
     struct wl_egl_window *m_waylandEglWindow;
@@ -79,6 +88,12 @@ private:
     mutable bool m_resize;
 
     QSurfaceFormat m_format;
+
+    uint m_frameCount;
+    uint m_decorationFrame;
+    QSize m_swappedSize;
+    // Content damage of the last frames, most recent first
+    QList<QRegion> m_damageHistory;
 };
 
 }
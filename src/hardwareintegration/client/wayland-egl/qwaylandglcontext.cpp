@@ -38,8 +38,10 @@
 #include <QtWaylandClient/private/qwaylandabstractdecoration_p.h>
 #include <QtWaylandClient/private/qwaylandintegration_p.h>
 #include "qwaylandeglwindow.h"
+#include "../../../shared/qwaylandframedamage.h"
 
 #include <QDebug>
+#include <QtCore/QThread>
 #include <QtPlatformSupport/private/qeglconvenience_p.h>
 #include <QtGui/private/qopenglcontext_p.h>
 #include <QtGui/private/qopengltexturecache_p.h>
@@ -73,6 +75,11 @@
 #define EGL_CONTEXT_OPENGL_COMPATIBILITY_PROFILE_BIT_KHR 0x00000002
 #endif
 
+// Constant from EGL_EXT_buffer_age
+#ifndef EGL_BUFFER_AGE_EXT
+#define EGL_BUFFER_AGE_EXT 0x313D
+#endif
+
 // Constants for OpenGL which are not available in the ES headers.
 #ifndef GL_CONTEXT_FLAGS
 #define GL_CONTEXT_FLAGS 0x821E
@@ -132,7 +139,7 @@ public:
     {
         delete m_blitProgram;
     }
-    void blit(QWaylandEglWindow *window)
+    void blit(QWaylandEglWindow *window, bool drawDecoration, const QRect &contentCopy)
     {
         QOpenGLTextureCache *cache = QOpenGLTextureCache::cacheForContext(m_context->context());
 
@@ -182,26 +189,48 @@ public:
         glActiveTexture(GL_TEXTURE0);
 
         //Draw Decoration
-        m_blitProgram->setAttributeArray(0, inverseSquareVertices, 2);
-        QImage decorationImage = window->decoration()->contentImage();
-        cache->bindTexture(m_context->context(), decorationImage);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-        if (m_context->context()->functions()->hasOpenGLFeature(QOpenGLFunctions::NPOTTextureRepeat)) {
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        } else {
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        if (drawDecoration) {
+            m_blitProgram->setAttributeArray(0, inverseSquareVertices, 2);
+            QImage decorationImage = window->decoration()->contentImage();
+            cache->bindTexture(m_context->context(), decorationImage);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            if (m_context->context()->functions()->hasOpenGLFeature(QOpenGLFunctions::NPOTTextureRepeat)) {
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+            } else {
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            }
+            glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
         }
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
         //Draw Content
+        // The framebuffer can be larger than the content, which then fills
+        // its bottom-left corner
+        const QSize contentSize = window->geometry().size();
+        const QSize fboSize = window->contentFBOSize();
+        const GLfloat s = GLfloat(contentSize.width() * scale) / fboSize.width();
+        const GLfloat t = GLfloat(contentSize.height() * scale) / fboSize.height();
+        const GLfloat contentTextureVertices[] = {
+            0.0f, 0.0f,
+            s,    0.0f,
+            0.0f, t,
+            s,    t
+        };
         m_blitProgram->setAttributeArray(0, squareVertices, 2);
+        m_blitProgram->setAttributeArray(1, contentTextureVertices, 2);
         glBindTexture(GL_TEXTURE_2D, window->contentTexture());
         QRect r = window->contentsRect();
         glViewport(r.x(), r.y(), r.width() * scale, r.height() * scale);
+        if (contentCopy != QRect(QPoint(), contentSize)) {
+            glEnable(GL_SCISSOR_TEST);
+            glScissor(r.x() + contentCopy.x() * scale,
+                      r.y() + (contentSize.height() - contentCopy.y() - contentCopy.height()) * scale,
+                      contentCopy.width() * scale, contentCopy.height() * scale);
+        }
         glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        glDisable(GL_SCISSOR_TEST);
 
         //Cleanup
         m_blitProgram->disableAttributeArray(0);
@@ -220,7 +249,18 @@ QWaylandGLContext::QWaylandGLContext(EGLDisplay eglDisplay, QWaylandDisplay *dis
     , m_display(display)
     , m_blitter(0)
     , mUseNativeDefaultFbo(false)
+    , m_swapBuffersWithDamage(0)
+    , m_supportsBufferAge(q_hasEglExtension(eglDisplay, "EGL_EXT_buffer_age"))
+    , m_framePacing(qEnvironmentVariableIsSet("QT_WAYLAND_FRAME_PACING") && format.swapInterval() != 0)
 {
+    if (q_hasEglExtension(m_eglDisplay, "EGL_KHR_swap_buffers_with_damage")) {
+        m_swapBuffersWithDamage = reinterpret_cast<SwapBuffersWithDamage>(
+                    eglGetProcAddress("eglSwapBuffersWithDamageKHR"));
+    } else if (q_hasEglExtension(m_eglDisplay, "EGL_EXT_swap_buffers_with_damage")) {
+        m_swapBuffersWithDamage = reinterpret_cast<SwapBuffersWithDamage>(
+                    eglGetProcAddress("eglSwapBuffersWithDamageEXT"));
+    }
+
     QSurfaceFormat fmt = format;
     if (static_cast<QWaylandIntegration *>(QGuiApplicationPrivate::platformIntegration())->display()->supportsWindowDecoration())
         fmt.setAlphaBufferSize(8);
@@ -394,6 +434,11 @@ bool QWaylandGLContext::makeCurrent(QPlatformSurface *surface)
         return false;
     }
 
+    // With frame pacing, swapping never waits for the compositor inside EGL.
+    // Frame callbacks of our own throttle rendering instead.
+    if (m_framePacing)
+        eglSwapInterval(m_eglDisplay, 0);
+
     window->bindContentFBO();
 
     return true;
@@ -417,6 +462,7 @@ public:
         glGetIntegerv(GL_TEXTURE_BINDING_2D, (GLint *) &m_texture);
         glGetIntegerv(GL_FRAMEBUFFER_BINDING, (GLint *) &m_fbo);
         glGetIntegerv(GL_VIEWPORT, m_viewport);
+        glGetIntegerv(GL_SCISSOR_BOX, m_scissorBox);
         glGetIntegerv(GL_DEPTH_WRITEMASK, &m_depthWriteMask);
         glGetIntegerv(GL_COLOR_WRITEMASK, m_colorWriteMask);
         m_blend = glIsEnabled(GL_BLEND);
@@ -446,6 +492,7 @@ public:
         glBindTexture(GL_TEXTURE_2D, m_texture);
         glFuncs.glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
         glViewport(m_viewport[0], m_viewport[1], m_viewport[2], m_viewport[3]);
+        glScissor(m_scissorBox[0], m_scissorBox[1], m_scissorBox[2], m_scissorBox[3]);
         glDepthMask(m_depthWriteMask);
         glColorMask(m_colorWriteMask[0], m_colorWriteMask[1], m_colorWriteMask[2], m_colorWriteMask[3]);
         if (m_blend)
@@ -485,6 +532,7 @@ private:
     GLboolean m_cull;
     GLboolean m_scissor;
     GLint m_viewport[4];
+    GLint m_scissorBox[4];
     struct VertexAttrib {
         bool enabled;
         GLuint arrayBuffer;
@@ -506,6 +554,10 @@ void QWaylandGLContext::swapBuffers(QPlatformSurface *surface)
 
     EGLSurface eglSurface = window->eglSurface();
 
+    // What the application repainted, in window coordinates
+    QRegion damage = window->takeFrameDamage();
+    bool decorationChanged = false;
+
     if (window->decoration()) {
         makeCurrent(surface);
 
@@ -515,14 +567,54 @@ void QWaylandGLContext::swapBuffers(QPlatformSurface *surface)
 
         if (!m_blitter)
             m_blitter = new DecorationsBlitter(this);
-        m_blitter->blit(window);
+
+        decorationChanged = window->decoration()->isDirty();
+        if (decorationChanged)
+            window->markDecorationChanged();
+
+        // Only what changed since the back buffer was shown is copied over
+        const int age = bufferAge(eglSurface);
+        m_blitter->blit(window, !window->decorationUpToDate(age), window->contentDamageSince(age, damage));
+    }
+
+    if (m_framePacing) {
+        // Update requests wait for the frame callback, so the GUI thread
+        // never has to. Render threads swapping at their own pace are held
+        // back here until the previous frame is done.
+        if (QThread::currentThread() != QCoreApplication::instance()->thread())
+            window->waitForFrameSync();
+        window->requestFrame();
     }
 
-    eglSwapBuffers(m_eglDisplay, eglSurface);
+    // EGL commits the surface when swapping
+    window->flushProperties();
+
+    // Without damage from the application, or with buffers of a new size,
+    // the whole surface is damaged
+    const QSize bufferSize = window->bufferSize();
+    if (m_swapBuffersWithDamage && !damage.isEmpty() && bufferSize == window->swappedSize()) {
+        const int scale = window->scale();
+        const QMargins margins = window->frameMargins();
+        const QRect contentRect(QPoint(margins.left(), margins.top()), window->geometry().size());
+        const QRegion surfaceDamage = QWaylandFrameDamage::surfaceDamage(damage, contentRect, bufferSize / scale, decorationChanged);
+        const QVector<EGLint> rects = QWaylandFrameDamage::bufferRects(surfaceDamage, scale, bufferSize.height());
+        m_swapBuffersWithDamage(m_eglDisplay, eglSurface, rects.constData(), rects.size() / 4);
+    } else {
+        eglSwapBuffers(m_eglDisplay, eglSurface);
+    }
+    window->frameSwapped(bufferSize, damage);
 
     window->setCanResize(true);
 }
 
+int QWaylandGLContext::bufferAge(EGLSurface surface) const
+{
+    EGLint age = 0;
+    if (!m_supportsBufferAge || !eglQuerySurface(m_eglDisplay, surface, EGL_BUFFER_AGE_EXT, &age))
+        return 0;
+    return age;
+}
+
 GLuint QWaylandGLContext::defaultFramebufferObject(QPlatformSurface *surface) const
 {
     if (mUseNativeDefaultFbo)
@@ -76,6 +76,10 @@ public:
 
 private:
     void updateGLFormat();
+    int bufferAge(EGLSurface surface) const;
+
+    typedef EGLBoolean (EGLAPIENTRY *SwapBuffersWithDamage)(EGLDisplay display, EGLSurface surface,
+                                                            const EGLint *rects, EGLint count);
 
     EGLDisplay m_eglDisplay;
     QWaylandDisplay *m_display;
@@ -86,6 +90,9 @@ private:
     DecorationsBlitter *m_blitter;
     bool mUseNativeDefaultFbo;
     uint m_api;
+    SwapBuffersWithDamage m_swapBuffersWithDamage;
+    bool m_supportsBufferAge;
+    bool m_framePacing;
 
     friend class DecorationsBlitter;
 };
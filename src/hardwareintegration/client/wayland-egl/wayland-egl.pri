@@ -8,9 +8,11 @@ INCLUDEPATH += $$PWD
 
 SOURCES += $$PWD/qwaylandeglclientbufferintegration.cpp \
            $$PWD/qwaylandglcontext.cpp \
-           $$PWD/qwaylandeglwindow.cpp
+           $$PWD/qwaylandeglwindow.cpp \
+           $$PWD/../../../shared/qwaylandframedamage.cpp
 
 HEADERS += $$PWD/qwaylandeglclientbufferintegration.h \
            $$PWD/qwaylandglcontext.h \
            $$PWD/qwaylandeglwindow.h \
-           $$PWD/qwaylandeglinclude.h
+           $$PWD/qwaylandeglinclude.h \
+           $$PWD/../../../shared/qwaylandframedamage.h
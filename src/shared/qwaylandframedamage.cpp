@@ -0,0 +1,71 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the plugins of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qwaylandframedamage.h"
+
+QT_BEGIN_NAMESPACE
+
+/*
+    Returns the damage in surface coordinates. The content of the window is
+    at \a contentRect, the rest of the surface is the decoration, which is
+    damaged as a whole when \a decorationChanged.
+*/
+QRegion QWaylandFrameDamage::surfaceDamage(const QRegion &damage, const QRect &contentRect,
+                                           const QSize &surfaceSize, bool decorationChanged)
+{
+    const QRect surfaceRect(QPoint(), surfaceSize);
+    QRegion result = damage.translated(contentRect.topLeft()) & contentRect;
+    if (decorationChanged)
+        result += QRegion(surfaceRect) - contentRect;
+    return result & surfaceRect;
+}
+
+/*
+    Returns x, y, width and height of each rectangle in buffer pixels. EGL
+    puts the origin at the bottom-left corner of the surface.
+*/
+QVector<qint32> QWaylandFrameDamage::bufferRects(const QRegion &surfaceDamage, int scale, int bufferHeight)
+{
+    QVector<qint32> rects;
+    rects.reserve(surfaceDamage.rectCount() * 4);
+    foreach (const QRect &rect, surfaceDamage.rects()) {
+        rects << rect.x() * scale
+              << bufferHeight - (rect.y() + rect.height()) * scale
+              << rect.width() * scale
+              << rect.height() * scale;
+    }
+    return rects;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,173 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the plugins of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qwaylandpropertycodec.h"
+
+#include <QDataStream>
+
+#include <string.h>
+
+QT_BEGIN_NAMESPACE
+
+static inline void appendWord(QByteArray &data, quint32 word)
+{
+    data.append(reinterpret_cast<const char *>(&word), sizeof(word));
+}
+
+static inline void appendPadded(QByteArray &data, const char *bytes, int size)
+{
+    appendWord(data, size);
+    data.append(bytes, size);
+    static const char zeros[4] = { 0, 0, 0, 0 };
+    data.append(zeros, (4 - (size & 3)) & 3);
+}
+
+static inline bool readWord(const QByteArray &data, int &offset, quint32 &word)
+{
+    if (offset + int(sizeof(word)) > data.size())
+        return false;
+    memcpy(&word, data.constData() + offset, sizeof(word));
+    offset += sizeof(word);
+    return true;
+}
+
+static inline bool readPadded(const QByteArray &data, int &offset, const char *&bytes, int &size)
+{
+    quint32 length;
+    if (!readWord(data, offset, length) || length > quint32(data.size() - offset))
+        return false;
+    bytes = data.constData() + offset;
+    size = length;
+    offset += (size + 3) & ~3;
+    return offset <= data.size();
+}
+
+void QWaylandPropertyCodec::encode(QByteArray &data, uint id, const QVariant &value)
+{
+    appendWord(data, id);
+    switch (value.type()) {
+    case QVariant::Int:
+        appendWord(data, IntValue);
+        appendWord(data, quint32(value.toInt()));
+        break;
+    case QVariant::Bool:
+        appendWord(data, BoolValue);
+        appendWord(data, value.toBool());
+        break;
+    case QVariant::Double: {
+        appendWord(data, DoubleValue);
+        const double d = value.toDouble();
+        data.append(reinterpret_cast<const char *>(&d), sizeof(d));
+        break;
+    }
+    case QVariant::String: {
+        appendWord(data, StringValue);
+        const QString string = value.toString();
+        appendPadded(data, reinterpret_cast<const char *>(string.constData()), string.size() * sizeof(QChar));
+        break;
+    }
+    default: {
+        appendWord(data, VariantValue);
+        QByteArray bytes;
+        QDataStream ds(&bytes, QIODevice::WriteOnly);
+        ds << value;
+        appendPadded(data, bytes.constData(), bytes.size());
+        break;
+    }
+    }
+}
+
+/*
+    Decodes the record at \a offset and moves \a offset past it. Returns false
+    if the data is truncated or the type is unknown.
+*/
+bool QWaylandPropertyCodec::decode(const QByteArray &data, int &offset, uint &id, QVariant &value)
+{
+    quint32 propertyId;
+    quint32 type;
+    if (!readWord(data, offset, propertyId) || !readWord(data, offset, type))
+        return false;
+    id = propertyId;
+
+    switch (type) {
+    case IntValue: {
+        quint32 word;
+        if (!readWord(data, offset, word))
+            return false;
+        value = QVariant(int(word));
+        return true;
+    }
+    case BoolValue: {
+        quint32 word;
+        if (!readWord(data, offset, word))
+            return false;
+        value = QVariant(word != 0);
+        return true;
+    }
+    case DoubleValue: {
+        double d;
+        if (offset + int(sizeof(d)) > data.size())
+            return false;
+        memcpy(&d, data.constData() + offset, sizeof(d));
+        offset += sizeof(d);
+        value = QVariant(d);
+        return true;
+    }
+    case StringValue: {
+        const char *bytes;
+        int size;
+        if (!readPadded(data, offset, bytes, size))
+            return false;
+        QString string(size / int(sizeof(QChar)), Qt::Uninitialized);
+        memcpy(string.data(), bytes, string.size() * sizeof(QChar));
+        value = QVariant(string);
+        return true;
+    }
+    case VariantValue: {
+        const char *bytes;
+        int size;
+        if (!readPadded(data, offset, bytes, size))
+            return false;
+        QByteArray raw = QByteArray::fromRawData(bytes, size);
+        QDataStream ds(raw);
+        value = QVariant();
+        ds >> value;
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,67 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the plugins of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QWAYLANDPROPERTYCODEC_H
+#define QWAYLANDPROPERTYCODEC_H
+
+#include <QByteArray>
+#include <QVariant>
+
+QT_BEGIN_NAMESPACE
+
+/*
+    Encodes window properties for the update_properties request and the
+    set_properties event of qt_extended_surface. Each record is a 32-bit
+    property id, as announced with intern_property, a 32-bit value type and the
+    value, padded to 32 bits. Ints, doubles, bools and strings are stored
+    directly; anything else falls back to a QDataStream of the QVariant.
+*/
+class QWaylandPropertyCodec
+{
+public:
+    enum ValueType {
+        VariantValue = 0,
+        IntValue = 1,
+        DoubleValue = 2,
+        BoolValue = 3,
+        StringValue = 4
+    };
+
+    static void encode(QByteArray &data, uint id, const QVariant &value);
+    static bool decode(const QByteArray &data, int &offset, uint &id, QVariant &value);
+};
+
+QT_END_NAMESPACE
+
+#endif
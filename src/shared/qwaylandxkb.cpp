@@ -35,6 +35,9 @@
 #include "qwaylandxkb.h"
 
 #include <QString>
+#include <QVector>
+
+#include <algorithm>
 
 #ifndef QT_NO_WAYLAND_XKB
 
@@ -138,19 +141,70 @@ static const uint32_t KeyTbl[] = {
     0,                          0
 };
 
-static int lookupKeysym(xkb_keysym_t key)
+namespace {
+
+struct KeyTblEntry
 {
-    int code = 0;
-    int i = 0;
-    while (KeyTbl[i]) {
-        if (key == KeyTbl[i]) {
-            code = (int)KeyTbl[i+1];
-            break;
+    uint32_t keysym;
+    uint32_t key;
+};
+
+bool keysymLessThan(const KeyTblEntry &a, const KeyTblEntry &b) { return a.keysym < b.keysym; }
+bool entryKeysymLessThan(const KeyTblEntry &a, uint32_t keysym) { return a.keysym < keysym; }
+bool keyLessThan(const KeyTblEntry &a, const KeyTblEntry &b) { return a.key < b.key; }
+bool entryKeyLessThan(const KeyTblEntry &a, uint32_t key) { return a.key < key; }
+
+// KeyTbl sorted once by keysym and by Qt key. The sort is stable so that for
+// duplicate entries the first one in KeyTbl keeps precedence, as it did with
+// the linear search.
+struct KeyTblIndex
+{
+    KeyTblIndex()
+    {
+        for (int i = 0; KeyTbl[i]; i += 2) {
+            KeyTblEntry entry = { KeyTbl[i], KeyTbl[i + 1] };
+            byKeysym.append(entry);
         }
-        i += 2;
+        byKey = byKeysym;
+        std::stable_sort(byKeysym.begin(), byKeysym.end(), keysymLessThan);
+        std::stable_sort(byKey.begin(), byKey.end(), keyLessThan);
     }
 
-    return code;
+    QVector<KeyTblEntry> byKeysym;
+    QVector<KeyTblEntry> byKey;
+};
+
+}
+
+Q_GLOBAL_STATIC(KeyTblIndex, keyTblIndex)
+
+static inline bool isKeypadKeysym(xkb_keysym_t keysym)
+{
+    return keysym >= XKB_KEY_KP_Space && keysym <= XKB_KEY_KP_9;
+}
+
+static int lookupKeysym(xkb_keysym_t key)
+{
+    const QVector<KeyTblEntry> &table = keyTblIndex()->byKeysym;
+    QVector<KeyTblEntry>::const_iterator it = std::lower_bound(table.constBegin(), table.constEnd(),
+                                                               key, entryKeysymLessThan);
+    if (it != table.constEnd() && it->keysym == key)
+        return int(it->key);
+
+    return 0;
+}
+
+static xkb_keysym_t lookupQtKey(int key, bool keypad)
+{
+    const QVector<KeyTblEntry> &table = keyTblIndex()->byKey;
+    QVector<KeyTblEntry>::const_iterator it = std::lower_bound(table.constBegin(), table.constEnd(),
+                                                               uint32_t(key), entryKeyLessThan);
+    for (; it != table.constEnd() && it->key == uint32_t(key); ++it) {
+        if (isKeypadKeysym(it->keysym) == keypad)
+            return it->keysym;
+    }
+
+    return XKB_KEY_NoSymbol;
 }
 
 int QWaylandXkb::keysymToQtKey(xkb_keysym_t keysym, Qt::KeyboardModifiers &modifiers, const QString &text)
@@ -179,6 +233,28 @@ int QWaylandXkb::keysymToQtKey(xkb_keysym_t keysym, Qt::KeyboardModifiers &modif
     return code;
 }
 
+xkb_keysym_t QWaylandXkb::qtKeyToKeysym(int key, Qt::KeyboardModifiers modifiers)
+{
+    if (key >= Qt::Key_F1 && key <= Qt::Key_F35)
+        return XKB_KEY_F1 + (key - Qt::Key_F1);
+
+    const bool keypad = modifiers & Qt::KeypadModifier;
+    if (keypad && key >= Qt::Key_0 && key <= Qt::Key_9)
+        return XKB_KEY_KP_0 + (key - Qt::Key_0);
+
+    xkb_keysym_t keysym = lookupQtKey(key, keypad);
+    if (keysym != XKB_KEY_NoSymbol || key <= 0x1f || key == 0x7f || key >= Qt::Key_Escape)
+        return keysym;
+
+    // Printable keys: Qt reports letters in upper case, the keysym carries the case
+    uint ucs4 = uint(key);
+    if (!(modifiers & Qt::ShiftModifier))
+        ucs4 = QChar::toLower(ucs4);
+
+    // Latin-1 keysyms match their code point, the rest of Unicode is offset
+    return ucs4 <= 0xff ? ucs4 : (0x01000000 | ucs4);
+}
+
 Qt::KeyboardModifiers QWaylandXkb::modifiers(struct xkb_state *state)
 {
     Qt::KeyboardModifiers modifiers = Qt::NoModifier;
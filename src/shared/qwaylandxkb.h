@@ -46,6 +46,7 @@ class QWaylandXkb
 {
 public:
     static int keysymToQtKey(xkb_keysym_t keysym, Qt::KeyboardModifiers &modifiers, const QString &text);
+    static xkb_keysym_t qtKeyToKeysym(int key, Qt::KeyboardModifiers modifiers);
     static Qt::KeyboardModifiers modifiers(struct xkb_state *state);
 };
 
@@ -19,7 +19,8 @@ SOURCES += tst_client.cpp \
            mockinput.cpp \
            mockshell.cpp \
            mocksurface.cpp \
-           mockoutput.cpp
+           mockoutput.cpp \
+           ../../../src/shared/qwaylandframedamage.cpp
 HEADERS += mockcompositor.h \
            mockinput.h \
            mocksurface.h \
@@ -32,10 +32,12 @@
 ****************************************************************************/
 
 #include "mockcompositor.h"
+#include "../../../src/shared/qwaylandframedamage.h"
 
 #include <QBackingStore>
 #include <QPainter>
 #include <QScreen>
+#include <qpa/qplatformnativeinterface.h>
 
 #include <QtTest/QtTest>
 
@@ -134,6 +136,8 @@ private slots:
     void createDestroyWindow();
     void events();
     void backingStore();
+    void frameDamage();
+    void frameDamageProperty();
 
 private:
     MockCompositor *compositor;
@@ -235,6 +239,44 @@ void tst_WaylandClient::backingStore()
     QTRY_VERIFY(surface->image.isNull());
 }
 
+void tst_WaylandClient::frameDamage()
+{
+    // A window of 100x60 with a decoration around it
+    const QRect contentRect(5, 25, 100, 60);
+    const QSize surfaceSize(120, 90);
+
+    // Damage is moved below the decoration and kept inside of the content
+    QRegion damage = QRegion(10, 10, 20, 20) + QRegion(90, 50, 30, 30);
+    QRegion surfaceDamage = QWaylandFrameDamage::surfaceDamage(damage, contentRect, surfaceSize, false);
+    QCOMPARE(surfaceDamage, QRegion(15, 35, 20, 20) + QRegion(95, 75, 10, 10));
+
+    // A repainted decoration is damaged completely
+    surfaceDamage = QWaylandFrameDamage::surfaceDamage(damage, contentRect, surfaceSize, true);
+    QCOMPARE(surfaceDamage, QRegion(0, 0, 120, 90) - contentRect
+             + QRegion(15, 35, 20, 20) + QRegion(95, 75, 10, 10));
+    surfaceDamage = QWaylandFrameDamage::surfaceDamage(QRegion(), contentRect, surfaceSize, true);
+    QCOMPARE(surfaceDamage, QRegion(0, 0, 120, 90) - contentRect);
+
+    // Buffer rectangles are scaled and counted from the bottom
+    QVector<qint32> rects = QWaylandFrameDamage::bufferRects(QRegion(15, 35, 20, 20), 2, 180);
+    QCOMPARE(rects, QVector<qint32>() << 30 << 70 << 40 << 40);
+    rects = QWaylandFrameDamage::bufferRects(QRegion(0, 0, 120, 10), 1, 90);
+    QCOMPARE(rects, QVector<qint32>() << 0 << 80 << 120 << 10);
+    QVERIFY(QWaylandFrameDamage::bufferRects(QRegion(), 1, 90).isEmpty());
+}
+
+void tst_WaylandClient::frameDamageProperty()
+{
+    TestWindow window;
+    window.create();
+    QPlatformNativeInterface *native = QGuiApplication::platformNativeInterface();
+
+    // Frame damage is taken by the next swap and never sent as a property
+    native->setWindowProperty(window.handle(), QStringLiteral("_q_frame_damage"),
+                              QVariant::fromValue(QRegion(0, 0, 10, 10)));
+    QVERIFY(!native->windowProperties(window.handle()).contains(QStringLiteral("_q_frame_damage")));
+}
+
 int main(int argc, char **argv)
 {
     setenv("XDG_RUNTIME_DIR", ".", 1);
@@ -16,16 +16,22 @@ config_xkbcommon {
     } else {
         LIBS_PRIVATE += -lxkbcommon
     }
+    SOURCES += ../../../src/shared/qwaylandxkb.cpp
 } else {
     DEFINES += QT_NO_WAYLAND_XKB
 }
 
+CONFIG += wayland-scanner
+WAYLANDCLIENTSOURCES += \
+    ../../../src/extensions/touch-extension.xml
+
 SOURCES += tst_compositor.cpp \
            testcompositor.cpp \
            testkeyboardgrabber.cpp \
            mockclient.cpp \
            mockseat.cpp \
-           testinputdevice.cpp
+           testinputdevice.cpp \
+           ../../../src/shared/qwaylandpropertycodec.cpp
 
 HEADERS += testcompositor.h \
            testkeyboardgrabber.h \
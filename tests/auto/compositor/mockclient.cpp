@@ -55,6 +55,7 @@ MockClient::MockClient()
     , output(0)
     , registry(0)
     , wlshell(0)
+    , touchExtension(0)
 {
     if (!display)
         qFatal("MockClient(): wl_display_connect() failed");
@@ -87,6 +88,12 @@ const wl_output_listener MockClient::outputListener = {
     MockClient::outputScale
 };
 
+const qt_touch_extension_listener MockClient::touchExtensionListener = {
+    MockClient::touchExtensionTouch,
+    MockClient::touchExtensionConfigure,
+    MockClient::touchExtensionTouchFrame
+};
+
 MockClient::~MockClient()
 {
     wl_display_disconnect(display);
@@ -117,6 +124,71 @@ void MockClient::outputScale(void *, wl_output *, int)
 
 }
 
+void MockClient::touchExtensionTouch(void *, qt_touch_extension *,
+                                     uint32_t, uint32_t, uint32_t,
+                                     int32_t, int32_t, int32_t, int32_t,
+                                     int32_t, int32_t, uint32_t,
+                                     int32_t, int32_t, uint32_t, wl_array *)
+{
+
+}
+
+void MockClient::touchExtensionConfigure(void *, qt_touch_extension *, uint32_t)
+{
+
+}
+
+// Decodes the frame the same way QWaylandTouchExtension does
+void MockClient::touchExtensionTouchFrame(void *data, qt_touch_extension *, uint32_t, uint32_t, wl_array *array)
+{
+    MockClient *client = resolve(data);
+    QList<TouchFramePoint> frame;
+
+    const uint32_t *p = static_cast<const uint32_t *>(array->data);
+    const uint32_t *end = p + array->size / sizeof(uint32_t);
+    while (end - p >= 2) {
+        const uint32_t id = *p++;
+        const uint32_t header = *p++;
+
+        TouchFramePoint &point = client->m_touchPoints[id];
+        point.id = id;
+        point.state = header & 0xFF;
+        point.fields = header >> 16;
+        if (point.fields & QT_TOUCH_EXTENSION_FRAME_FIELD_POSITION) {
+            point.x = int32_t(*p++);
+            point.y = int32_t(*p++);
+        }
+        if (point.fields & QT_TOUCH_EXTENSION_FRAME_FIELD_NORMALIZED_POSITION) {
+            point.nx = int32_t(*p++);
+            point.ny = int32_t(*p++);
+        }
+        if (point.fields & QT_TOUCH_EXTENSION_FRAME_FIELD_SIZE) {
+            point.w = int32_t(*p++);
+            point.h = int32_t(*p++);
+        }
+        if (point.fields & QT_TOUCH_EXTENSION_FRAME_FIELD_PRESSURE)
+            point.pressure = *p++;
+        if (point.fields & QT_TOUCH_EXTENSION_FRAME_FIELD_VELOCITY) {
+            point.vx = int32_t(*p++);
+            point.vy = int32_t(*p++);
+        }
+        if (point.fields & QT_TOUCH_EXTENSION_FRAME_FIELD_RAW_POSITIONS) {
+            const uint32_t rawPosCount = *p++;
+            const float *raw = reinterpret_cast<const float *>(p);
+            point.rawPositions.resize(rawPosCount);
+            for (uint32_t i = 0; i < rawPosCount; ++i)
+                point.rawPositions[i] = QPointF(raw[2 * i], raw[2 * i + 1]);
+            p += rawPosCount * 2;
+        }
+
+        frame << point;
+        if (point.state == Qt::TouchPointReleased)
+            client->m_touchPoints.remove(id);
+    }
+
+    client->touchFrames << frame;
+}
+
 void MockClient::readEvents()
 {
     wl_display_dispatch(display);
@@ -147,6 +219,9 @@ void MockClient::handleGlobal(uint32_t id, const QByteArray &interface)
     } else if (interface == "wl_seat") {
         wl_seat *s = static_cast<wl_seat *>(wl_registry_bind(registry, id, &wl_seat_interface, 1));
         m_seats << new MockSeat(s);
+    } else if (interface == "qt_touch_extension") {
+        touchExtension = static_cast<qt_touch_extension *>(wl_registry_bind(registry, id, &qt_touch_extension_interface, 2));
+        qt_touch_extension_add_listener(touchExtension, &touchExtensionListener, this);
     }
 }
 
@@ -162,6 +237,28 @@ wl_shell_surface *MockClient::createShellSurface(wl_surface *surface)
     return wl_shell_get_shell_surface(wlshell, surface);
 }
 
+// Creates a shell surface showing all of the buffer
+wl_surface *MockClient::createMappedSurface(const ShmBuffer &buffer, wl_shell_surface **shellSurface)
+{
+    wl_surface *surface = createSurface();
+    wl_shell_surface *shell = createShellSurface(surface);
+    if (shellSurface)
+        *shellSurface = shell;
+    commitBuffer(surface, buffer);
+    return surface;
+}
+
+// Attaches the buffer and commits it with the given damage, all of it if
+// none is given
+void MockClient::commitBuffer(wl_surface *surface, const ShmBuffer &buffer, const QRect &damage)
+{
+    const QRect rect = damage.isNull() ? QRect(QPoint(), buffer.image.size()) : damage;
+    wl_surface_attach(surface, buffer.handle, 0, 0);
+    wl_surface_damage(surface, rect.x(), rect.y(), rect.width(), rect.height());
+    wl_surface_commit(surface);
+    flushDisplay();
+}
+
 ShmBuffer::ShmBuffer(const QSize &size, wl_shm *shm)
     : handle(0)
 {
@@ -32,11 +32,15 @@
 ****************************************************************************/
 
 #include <wayland-client.h>
+#include "wayland-touch-extension-client-protocol.h"
 
 #include <QObject>
 #include <QImage>
 #include <QRect>
 #include <QList>
+#include <QHash>
+#include <QVector>
+#include <QPointF>
 
 class MockSeat;
 
@@ -61,6 +65,24 @@ public:
 
     wl_surface *createSurface();
     wl_shell_surface *createShellSurface(wl_surface *surface);
+    wl_surface *createMappedSurface(const ShmBuffer &buffer, wl_shell_surface **shellSurface = 0);
+    void commitBuffer(wl_surface *surface, const ShmBuffer &buffer, const QRect &damage = QRect());
+
+    // A point of a qt_touch_extension.touch_frame, with the fields left out
+    // of the frame filled in from the previous frames
+    struct TouchFramePoint {
+        TouchFramePoint() : id(0), state(0), fields(0), x(0), y(0), nx(0), ny(0),
+            w(0), h(0), pressure(0), vx(0), vy(0) {}
+        uint32_t id;
+        uint32_t state;
+        uint32_t fields;
+        int x, y;
+        int nx, ny;
+        int w, h;
+        uint32_t pressure;
+        int vx, vy;
+        QVector<QPointF> rawPositions;
+    };
 
     wl_display *display;
     wl_compositor *compositor;
@@ -68,11 +90,14 @@ public:
     wl_shm *shm;
     wl_registry *registry;
     wl_shell *wlshell;
+    qt_touch_extension *touchExtension;
 
     QList<MockSeat *> m_seats;
 
     QRect geometry;
 
+    QList<QList<TouchFramePoint> > touchFrames;
+
     int fd;
 
 private slots:
@@ -103,8 +128,23 @@ private:
     static void outputDone(void *data, wl_output *output);
     static void outputScale(void *data, wl_output *output, int factor);
 
+    static void touchExtensionTouch(void *data, qt_touch_extension *extension,
+                                    uint32_t time, uint32_t id, uint32_t state,
+                                    int32_t x, int32_t y,
+                                    int32_t normalizedX, int32_t normalizedY,
+                                    int32_t width, int32_t height,
+                                    uint32_t pressure,
+                                    int32_t velocityX, int32_t velocityY,
+                                    uint32_t flags, wl_array *rawData);
+    static void touchExtensionConfigure(void *data, qt_touch_extension *extension, uint32_t flags);
+    static void touchExtensionTouchFrame(void *data, qt_touch_extension *extension,
+                                         uint32_t time, uint32_t flags, wl_array *data);
+
     void handleGlobal(uint32_t id, const QByteArray &interface);
 
     static const wl_output_listener outputListener;
+    static const qt_touch_extension_listener touchExtensionListener;
+
+    QHash<uint32_t, TouchFramePoint> m_touchPoints;
 };
 
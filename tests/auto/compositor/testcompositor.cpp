@@ -33,6 +33,9 @@
 
 #include "testcompositor.h"
 
+#include <QtCore/QElapsedTimer>
+#include <QtTest/QTest>
+
 TestCompositor::TestCompositor(QWaylandCompositor::ExtensionFlag flags) : QWaylandCompositor(0, flags)
 {
     createOutput(0, "", "");
@@ -49,4 +52,19 @@ void TestCompositor::surfaceAboutToBeDestroyed(QWaylandSurface *surface)
     surfaces.removeOne(surface);
 }
 
+// Waits for the surface created last to be mapped. Returns it, or null if
+// that did not happen within timeout milliseconds.
+QWaylandSurface *TestCompositor::waitForMappedSurface(int timeout)
+{
+    QElapsedTimer timer;
+    timer.start();
+    forever {
+        if (!surfaces.isEmpty() && surfaces.last()->isMapped())
+            return surfaces.last();
+        if (timer.elapsed() > timeout)
+            return Q_NULLPTR;
+        QTest::qWait(10);
+    }
+}
+
 
@@ -42,6 +42,8 @@ public:
     void surfaceCreated(QWaylandSurface *surface);
     void surfaceAboutToBeDestroyed(QWaylandSurface *surface);
 
+    QWaylandSurface *waitForMappedSurface(int timeout = 5000);
+
     QList<QWaylandSurface *> surfaces;
 };
 
@@ -38,14 +38,38 @@
 #include "QtCompositor/private/qwlkeyboard_p.h"
 #include "QtCompositor/private/qwlinputdevice_p.h"
 #include "QtCompositor/private/qwlcompositor_p.h"
+#include "QtCompositor/private/qwldamageaccumulator_p.h"
+#include "QtCompositor/private/qwlinputregion_p.h"
 #include "testinputdevice.h"
 
 #include "qwaylandbufferref.h"
+#include "qwaylandclient.h"
+#include "qwaylandsoftwareoutput.h"
+#include "qwaylandoutputcapture.h"
+#include "qwaylandoutputdamage.h"
+#include "qwaylandsurfaceview.h"
+#ifdef QT_COMPOSITOR_WAYLAND_GL
+#include "qwaylandbatchrenderer.h"
+#endif
+#include "../../../src/shared/qwaylandpropertycodec.h"
+
+#ifndef QT_NO_WAYLAND_XKB
+#include "../../../src/shared/qwaylandxkb.h"
+#include <xkbcommon/xkbcommon-keysyms.h>
+#endif
 
 #include <QtTest/QtTest>
 
 #include <QtCompositor/private/qwlinputdevice_p.h>
 
+#ifdef QT_COMPOSITOR_WAYLAND_GL
+#include <QtGui/QOffscreenSurface>
+#include <QtGui/QOpenGLContext>
+#include <QtGui/QOpenGLFramebufferObject>
+#endif
+
+#include <limits>
+
 class tst_WaylandCompositor : public QObject
 {
     Q_OBJECT
@@ -59,12 +83,41 @@ private slots:
     void inputDeviceCapabilities();
     void keyboardGrab();
     void inputDeviceCreation();
+    void inputDeviceTouchRouting();
+    void touchFrame();
     void inputDeviceKeyboardFocus();
     void singleClient();
     void multipleClients();
     void geometry();
     void mapSurface();
     void frameCallback();
+    void frameCallbackCoalescing();
+    void softwareOutput();
+    void softwareOutputIdle();
+    void softwareOutputCursor();
+    void outputDamage();
+    void damageAccumulatorBounded();
+    void damageAccumulatorMerge();
+    void damageAccumulatorExact();
+    void damageAccumulatorSurface();
+    void inputRegion();
+#ifdef QT_COMPOSITOR_WAYLAND_GL
+    void batchRendererAtlas();
+    void batchRendererDamage();
+    void batchRendererLargeSurfaces();
+    void batchRendererAtlasOverflow();
+#endif
+    void outputCapture();
+    void batchedFlush();
+    void earlyShmBufferRelease();
+    void bufferRef();
+    void pingLiveness();
+    void shellSurfaceConfigureThrottle();
+    void propertyCodec();
+#ifndef QT_NO_WAYLAND_XKB
+    void xkbKeysymToQtKey();
+    void xkbQtKeyToKeysym();
+#endif
 };
 
 void tst_WaylandCompositor::singleClient()
@@ -302,6 +355,902 @@ void tst_WaylandCompositor::frameCallback()
     wl_surface_destroy(surface);
 }
 
+void tst_WaylandCompositor::frameCallbackCoalescing()
+{
+    TestCompositor compositor;
+
+    MockClient client;
+
+    wl_surface *surface = client.createSurface();
+
+    QTRY_COMPARE(compositor.surfaces.size(), 1);
+    QWaylandSurface *waylandSurface = compositor.surfaces.at(0);
+    QSignalSpy redrawSpy(waylandSurface, SIGNAL(redraw()));
+
+    // A client committing without waiting for its callbacks only has the
+    // most recent ones held back until the next frame
+    int frameCounter = 0;
+    for (int i = 0; i < 20; ++i) {
+        registerFrameCallback(surface, &frameCounter);
+        wl_surface_commit(surface);
+    }
+    QTRY_COMPARE(redrawSpy.count(), 20);
+    QTRY_COMPARE(frameCounter, 12);
+
+    // Callbacks requested after the frame started wait for the next one
+    compositor.frameStarted();
+    registerFrameCallback(surface, &frameCounter);
+    wl_surface_commit(surface);
+    QTRY_COMPARE(redrawSpy.count(), 21);
+    compositor.sendFrameCallbacks(QList<QWaylandSurface *>() << waylandSurface);
+    QTRY_COMPARE(frameCounter, 20);
+
+    compositor.frameStarted();
+    compositor.sendFrameCallbacks(QList<QWaylandSurface *>() << waylandSurface);
+    QTRY_COMPARE(frameCounter, 21);
+
+    // Pending callbacks are cleaned up with the surface
+    registerFrameCallback(surface, &frameCounter);
+    wl_surface_destroy(surface);
+    QTRY_COMPARE(compositor.surfaces.size(), 0);
+}
+
+static void bufferReleaseFunc(void *data, wl_buffer *)
+{
+    ++*static_cast<int *>(data);
+}
+
+void tst_WaylandCompositor::earlyShmBufferRelease()
+{
+    TestCompositor compositor;
+    compositor.setEarlyShmBufferReleaseEnabled(true);
+
+    MockClient client;
+
+    wl_surface *surface = client.createSurface();
+    QTRY_COMPARE(compositor.surfaces.size(), 1);
+    QWaylandSurface *waylandSurface = compositor.surfaces.at(0);
+
+    QSize size(32, 32);
+    ShmBuffer buffer(size, client.shm);
+    buffer.image.fill(Qt::red);
+
+    static const wl_buffer_listener bufferListener = {
+        bufferReleaseFunc
+    };
+    int releaseCount = 0;
+    wl_buffer_add_listener(buffer.handle, &bufferListener, &releaseCount);
+
+    wl_surface_attach(surface, buffer.handle, 0, 0);
+    wl_surface_damage(surface, 0, 0, size.width(), size.height());
+    wl_surface_commit(surface);
+
+    // The buffer comes back while the surface still shows it
+    QTRY_COMPARE(releaseCount, 1);
+    QWaylandBufferRef ref = waylandSurface->handle()->currentBuffer();
+    QVERIFY(ref);
+    QCOMPARE(ref.image().pixel(0, 0), QColor(Qt::red).rgba());
+
+    // Drawing into the released buffer does not affect the shown contents
+    buffer.image.fill(Qt::green);
+    QCOMPARE(ref.image().pixel(0, 0), QColor(Qt::red).rgba());
+
+    // Only the damaged part of the reused buffer is taken over
+    wl_surface_attach(surface, buffer.handle, 0, 0);
+    wl_surface_damage(surface, 8, 8, 4, 4);
+    wl_surface_commit(surface);
+
+    QTRY_COMPARE(releaseCount, 2);
+    ref = waylandSurface->handle()->currentBuffer();
+    QCOMPARE(ref.image().pixel(9, 9), QColor(Qt::green).rgba());
+    QCOMPARE(ref.image().pixel(0, 0), QColor(Qt::red).rgba());
+
+    // Without other references to the previous buffer, the retained content
+    // is updated in place instead of being copied
+    const uchar *bits = ref.image().constBits();
+    ref = QWaylandBufferRef();
+    buffer.image.fill(Qt::blue);
+    wl_surface_attach(surface, buffer.handle, 0, 0);
+    wl_surface_damage(surface, 0, 0, 4, 4);
+    wl_surface_commit(surface);
+    QTRY_COMPARE(releaseCount, 3);
+    ref = waylandSurface->handle()->currentBuffer();
+    QCOMPARE(ref.image().constBits(), bits);
+    QCOMPARE(ref.image().pixel(1, 1), QColor(Qt::blue).rgba());
+    QCOMPARE(ref.image().pixel(9, 9), QColor(Qt::green).rgba());
+
+    wl_surface_destroy(surface);
+}
+
+void tst_WaylandCompositor::bufferRef()
+{
+    QCOMPARE(sizeof(QWaylandBufferRef), sizeof(void *));
+
+    TestCompositor compositor;
+    MockClient client;
+    ShmBuffer buffer(QSize(16, 16), client.shm);
+    buffer.image.fill(Qt::red);
+    wl_surface *surface = client.createMappedSurface(buffer);
+    QWaylandSurface *waylandSurface = compositor.waitForMappedSurface();
+    QVERIFY(waylandSurface);
+
+    // Copies share the buffer, moves take it over
+    QWaylandBufferRef ref = waylandSurface->handle()->currentBuffer();
+    QVERIFY(ref);
+    QWaylandBufferRef copy(ref);
+    QVERIFY(copy);
+    QCOMPARE(copy.image().pixel(0, 0), QColor(Qt::red).rgba());
+    QWaylandBufferRef moved(std::move(copy));
+    QVERIFY(moved);
+    QVERIFY(!copy);
+    copy = std::move(moved);
+    QVERIFY(copy);
+    QVERIFY(!moved);
+    ref = QWaylandBufferRef();
+    QVERIFY(!ref);
+    QVERIFY(copy);
+
+    wl_surface_destroy(surface);
+}
+
+static void shellSurfacePing(void *data, wl_shell_surface *, uint32_t serial)
+{
+    *static_cast<uint32_t *>(data) = serial;
+}
+
+static void shellSurfaceConfigure(void *, wl_shell_surface *, uint32_t, int32_t, int32_t)
+{
+}
+
+static void shellSurfacePopupDone(void *, wl_shell_surface *)
+{
+}
+
+void tst_WaylandCompositor::pingLiveness()
+{
+    TestCompositor compositor;
+    compositor.setPingInterval(10);
+    compositor.setUnresponsiveTimeout(50);
+
+    MockClient client;
+
+    wl_surface *surface = client.createSurface();
+    QTRY_COMPARE(compositor.surfaces.size(), 1);
+    QWaylandSurface *waylandSurface = compositor.surfaces.at(0);
+    QWaylandClient *waylandClient = waylandSurface->client();
+    QSignalSpy responsiveSpy(waylandClient, SIGNAL(responsiveChanged(bool)));
+
+    static const wl_shell_surface_listener shellSurfaceListener = {
+        shellSurfacePing,
+        shellSurfaceConfigure,
+        shellSurfacePopupDone
+    };
+    uint32_t serial = 0;
+    wl_shell_surface *shellSurface = client.createShellSurface(surface);
+    wl_shell_surface_add_listener(shellSurface, &shellSurfaceListener, &serial);
+
+    QSize size(32, 32);
+    ShmBuffer buffer(size, client.shm);
+    wl_surface_attach(surface, buffer.handle, 0, 0);
+    wl_surface_damage(surface, 0, 0, size.width(), size.height());
+    wl_surface_commit(surface);
+    QTRY_VERIFY(waylandSurface->isMapped());
+    QSignalSpy pongSpy(waylandSurface, SIGNAL(pong()));
+
+    // Leave the ping unanswered until the client is reported as hung
+    QTRY_VERIFY(serial != 0);
+    QTRY_VERIFY(!waylandClient->isResponsive());
+    QCOMPARE(responsiveSpy.count(), 1);
+    QCOMPARE(waylandClient->pingLatency(), qint64(-1));
+
+    wl_shell_surface_pong(shellSurface, serial);
+    QTRY_VERIFY(waylandClient->isResponsive());
+    QCOMPARE(responsiveSpy.count(), 2);
+    QVERIFY(waylandClient->pingLatency() >= 50);
+
+    QVector<quint64> histogram = waylandClient->pingLatencyHistogram();
+    quint64 pongs = 0;
+    for (int i = 0; i < histogram.size(); ++i) {
+        pongs += histogram.at(i);
+        // 50 ms and more are counted from the [32, 64) ms bucket on
+        if (i < 6)
+            QCOMPARE(histogram.at(i), quint64(0));
+    }
+    QCOMPARE(pongs, quint64(1));
+
+    // Liveness pongs are not reported as answers to QWaylandSurface::ping()
+    QCOMPARE(pongSpy.count(), 0);
+    compositor.setPingInterval(0);
+    serial = 0;
+    waylandSurface->ping();
+    QTRY_VERIFY(serial != 0);
+    wl_shell_surface_pong(shellSurface, serial);
+    QTRY_COMPARE(pongSpy.count(), 1);
+    QCOMPARE(histogram, waylandClient->pingLatencyHistogram());
+
+    wl_surface_destroy(surface);
+}
+
+static void configurePing(void *, wl_shell_surface *shellSurface, uint32_t serial)
+{
+    wl_shell_surface_pong(shellSurface, serial);
+}
+
+static void configureRecord(void *data, wl_shell_surface *, uint32_t, int32_t width, int32_t height)
+{
+    static_cast<QList<QSize> *>(data)->append(QSize(width, height));
+}
+
+void tst_WaylandCompositor::shellSurfaceConfigureThrottle()
+{
+    TestCompositor compositor;
+    compositor.primaryOutput()->setMode({QSize(320, 240), 60});
+    MockClient client;
+
+    static const wl_shell_surface_listener shellSurfaceListener = {
+        configurePing,
+        configureRecord,
+        shellSurfacePopupDone
+    };
+    QList<QSize> configures;
+    wl_shell_surface *shellSurface = 0;
+    ShmBuffer buffer(QSize(32, 32), client.shm);
+    wl_surface *surface = client.createMappedSurface(buffer, &shellSurface);
+    wl_shell_surface_add_listener(shellSurface, &shellSurfaceListener, &configures);
+    QWaylandSurface *waylandSurface = compositor.waitForMappedSurface();
+    QVERIFY(waylandSurface);
+
+    waylandSurface->requestSize(QSize(100, 100));
+    QTRY_COMPARE(configures.size(), 1);
+    QCOMPARE(configures.last(), QSize(100, 100));
+
+    // Sizes requested while a configure is in flight are coalesced
+    waylandSurface->requestSize(QSize(200, 200));
+    waylandSurface->requestSize(QSize(300, 300));
+    QTest::qWait(50);
+    QCOMPARE(configures.size(), 1);
+
+    // A new buffer answers it, and only the latest size follows
+    client.commitBuffer(surface, buffer);
+    QTRY_COMPARE(configures.size(), 2);
+    QCOMPARE(configures.last(), QSize(300, 300));
+
+    // Clients that do not answer are sent the next size after a timeout
+    waylandSurface->requestSize(QSize(400, 400));
+    QTest::qWait(50);
+    QCOMPARE(configures.size(), 2);
+    QTRY_COMPARE(configures.size(), 3);
+    QCOMPARE(configures.last(), QSize(400, 400));
+
+    // Going fullscreen replaces a size that is still waiting
+    waylandSurface->requestSize(QSize(500, 500));
+    wl_shell_surface_set_fullscreen(shellSurface, WL_SHELL_SURFACE_FULLSCREEN_METHOD_DEFAULT, 0, 0);
+    client.commitBuffer(surface, buffer);
+    QTRY_COMPARE(configures.size(), 4);
+    QCOMPARE(configures.last(), QSize(320, 240));
+    QTest::qWait(250);
+    QCOMPARE(configures.size(), 4);
+
+    wl_surface_destroy(surface);
+}
+
+void tst_WaylandCompositor::softwareOutput()
+{
+    TestCompositor compositor;
+    QWaylandSoftwareOutput output(&compositor, QSize(320, 240), "", "");
+    output.setClearColor(Qt::blue);
+    compositor.setPrimaryOutput(&output);
+
+    output.render();
+    QCOMPARE(output.framebuffer().size(), QSize(320, 240));
+    QCOMPARE(output.framebuffer().pixel(10, 10), QColor(Qt::blue).rgba());
+
+    MockClient client;
+
+    wl_surface *surface = client.createSurface();
+    QTRY_COMPARE(compositor.surfaces.size(), 1);
+
+    QSignalSpy renderedSpy(&output, SIGNAL(frameRendered(const QRegion &)));
+
+    QSize size(64, 64);
+    ShmBuffer buffer(size, client.shm);
+    buffer.image.fill(Qt::red);
+
+    client.createShellSurface(surface);
+    wl_surface_attach(surface, buffer.handle, 0, 0);
+    wl_surface_damage(surface, 0, 0, size.width(), size.height());
+    wl_surface_commit(surface);
+
+    // Frames are driven by the output refresh timer
+    QTRY_COMPARE(renderedSpy.count(), 1);
+    QCOMPARE(output.damage(), QRegion(0, 0, 64, 64));
+    QCOMPARE(output.framebuffer().pixel(10, 10), QColor(Qt::red).rgba());
+    QCOMPARE(output.framebuffer().pixel(100, 100), QColor(Qt::blue).rgba());
+
+    // Only the damaged part of the surface gets recomposited
+    int frameCounter = 0;
+    wl_surface_attach(surface, buffer.handle, 0, 0);
+    registerFrameCallback(surface, &frameCounter);
+    wl_surface_damage(surface, 8, 8, 4, 4);
+    wl_surface_commit(surface);
+
+    QTRY_COMPARE(renderedSpy.count(), 2);
+    QCOMPARE(output.damage(), QRegion(8, 8, 4, 4));
+    QTRY_COMPARE(frameCounter, 1);
+
+    wl_surface_destroy(surface);
+}
+
+void tst_WaylandCompositor::softwareOutputIdle()
+{
+    TestCompositor compositor;
+    QWaylandSoftwareOutput output(&compositor, QSize(320, 240), "", "");
+    output.setClearColor(Qt::blue);
+    compositor.setPrimaryOutput(&output);
+
+    // Let the output render its first frame and stop refreshing
+    QSignalSpy renderedSpy(&output, SIGNAL(frameRendered(const QRegion &)));
+    QTRY_COMPARE(renderedSpy.count(), 1);
+    QTest::qWait(200);
+    QCOMPARE(renderedSpy.count(), 1);
+
+    MockClient client;
+
+    wl_surface *surface = client.createSurface();
+    QTRY_COMPARE(compositor.surfaces.size(), 1);
+
+    QSize size(64, 64);
+    ShmBuffer buffer(size, client.shm);
+    buffer.image.fill(Qt::red);
+
+    client.createShellSurface(surface);
+    wl_surface_attach(surface, buffer.handle, 0, 0);
+    wl_surface_damage(surface, 0, 0, size.width(), size.height());
+    wl_surface_commit(surface);
+
+    QTRY_COMPARE(renderedSpy.count(), 2);
+    QCOMPARE(output.framebuffer().pixel(10, 10), QColor(Qt::red).rgba());
+
+    wl_surface_destroy(surface);
+}
+
+void tst_WaylandCompositor::outputDamage()
+{
+    TestCompositor compositor;
+    QWaylandSoftwareOutput output(&compositor, QSize(320, 240), "", "");
+    compositor.setPrimaryOutput(&output);
+
+    QWaylandOutputDamage damage(&output);
+    const QRegion bounds(0, 0, 320, 240);
+    QCOMPARE(damage.damageSince(1), bounds);
+    damage.endFrame();
+    QCOMPARE(damage.damage(), QRegion());
+
+    MockClient client;
+
+    ShmBuffer buffer(QSize(64, 64), client.shm);
+    wl_surface *surface = client.createMappedSurface(buffer);
+    QWaylandSurface *waylandSurface = compositor.waitForMappedSurface();
+    QVERIFY(waylandSurface);
+    QCOMPARE(waylandSurface->views().size(), 1);
+
+    QWaylandSurfaceView *view = waylandSurface->views().first();
+    view->setPos(QPointF(10, 20));
+    const QList<QWaylandSurfaceView *> views = QList<QWaylandSurfaceView *>() << view;
+
+    // A newly shown view damages its whole geometry
+    damage.setViews(views);
+    QCOMPARE(damage.damage(), QRegion(10, 20, 64, 64));
+    damage.endFrame();
+
+    // Surface damage is translated to the view position
+    QSignalSpy damagedSpy(&damage, SIGNAL(damaged(const QRegion &)));
+    client.commitBuffer(surface, buffer, QRect(8, 8, 4, 4));
+    QTRY_COMPARE(damagedSpy.count(), 1);
+    QCOMPARE(damage.damage(), QRegion(18, 28, 4, 4));
+
+    // Older back buffers also miss the damage of the frames since
+    QCOMPARE(damage.damageSince(2), QRegion(10, 20, 64, 64));
+    QCOMPARE(damage.damageSince(3), bounds);
+    QCOMPARE(damage.damageSince(0), bounds);
+    damage.endFrame();
+
+    // Moving damages the old and the new geometry
+    view->setPos(QPointF(100, 20));
+    damage.setViews(views);
+    QCOMPARE(damage.damage(), QRegion(10, 20, 64, 64) + QRegion(100, 20, 64, 64));
+    damage.endFrame();
+
+    // Hiding damages what the view covered
+    damage.setViews(QList<QWaylandSurfaceView *>());
+    QCOMPARE(damage.damage(), QRegion(100, 20, 64, 64));
+
+    // Buffers older than the remembered frames are repainted completely
+    damage.setMaxBufferAge(2);
+    QCOMPARE(damage.damageSince(2), QRegion(10, 20, 64, 64) + QRegion(100, 20, 64, 64));
+    QCOMPARE(damage.damageSince(3), bounds);
+    damage.endFrame();
+
+    // Destroying a shown view damages what it covered and forgets it
+    QWaylandSurfaceView *extraView = new QWaylandSurfaceView(waylandSurface);
+    extraView->setPos(QPointF(200, 100));
+    damage.setViews(QList<QWaylandSurfaceView *>() << extraView);
+    damage.endFrame();
+    delete extraView;
+    QCOMPARE(damage.damage(), QRegion(200, 100, 64, 64));
+    damage.endFrame();
+    damage.setViews(QList<QWaylandSurfaceView *>());
+    QCOMPARE(damage.damage(), QRegion());
+
+    wl_surface_destroy(surface);
+}
+
+void tst_WaylandCompositor::damageAccumulatorBounded()
+{
+    using QtWayland::DamageAccumulator;
+
+    // Bounded damage covers everything added, with few rectangles
+    DamageAccumulator damage(DamageAccumulator::Bounded, 8);
+    QRegion added;
+    for (int i = 0; i < 200; ++i) {
+        const QRect rect((i * 37) % 1000, (i * 53) % 800, 3, 3);
+        damage.add(rect);
+        added += rect;
+    }
+    QVERIFY(damage.rectCount() <= 8);
+    QVERIFY((added - damage.region()).isEmpty());
+    QCOMPARE(damage.boundingRect(), added.boundingRect());
+
+    damage.clear();
+    QVERIFY(damage.isEmpty());
+}
+
+void tst_WaylandCompositor::damageAccumulatorMerge()
+{
+    using QtWayland::DamageAccumulator;
+
+    // Covered rectangles are dropped, distant ones are kept apart
+    DamageAccumulator damage(DamageAccumulator::Bounded, 8);
+    damage.add(QRect(0, 0, 10, 10));
+    damage.add(QRect(2, 2, 4, 4));
+    damage.add(QRect(500, 500, 10, 10));
+    QCOMPARE(damage.rectCount(), 2);
+    QCOMPARE(damage.region(), QRegion(0, 0, 10, 10) + QRegion(500, 500, 10, 10));
+
+    // Rectangles filling most of their bounding rectangle collapse into it
+    damage.add(QRect(0, 10, 510, 490));
+    QCOMPARE(damage.rectCount(), 1);
+    QCOMPARE(damage.region(), QRegion(0, 0, 510, 510));
+}
+
+void tst_WaylandCompositor::damageAccumulatorExact()
+{
+    using QtWayland::DamageAccumulator;
+
+    // Exact accumulators give what QRegion arithmetic gives
+    DamageAccumulator region(DamageAccumulator::Exact);
+    QRegion expected;
+    for (int i = 0; i < 50; ++i) {
+        const QRect rect(i * 7, i * 5, 20, 20);
+        region.add(rect);
+        expected += rect;
+    }
+    region.subtract(QRect(50, 50, 100, 100));
+    expected -= QRect(50, 50, 100, 100);
+    region.add(QRect(60, 60, 10, 10));
+    expected += QRect(60, 60, 10, 10);
+    QVERIFY((region.region() ^ expected).isEmpty());
+}
+
+void tst_WaylandCompositor::damageAccumulatorSurface()
+{
+    // A client damaging a surface in hundreds of small rectangles
+    TestCompositor compositor;
+    MockClient client;
+    wl_surface *surface = client.createSurface();
+    QTRY_COMPARE(compositor.surfaces.size(), 1);
+    QWaylandSurface *waylandSurface = compositor.surfaces.at(0);
+
+    QSize size(256, 256);
+    ShmBuffer buffer(size, client.shm);
+    QSignalSpy damagedSpy(waylandSurface, SIGNAL(damaged(const QRegion &)));
+    wl_surface_attach(surface, buffer.handle, 0, 0);
+    QRegion added;
+    for (int y = 0; y < 256; y += 16) {
+        for (int x = (y / 16) % 2 * 8; x < 256; x += 16) {
+            wl_surface_damage(surface, x, y, 8, 8);
+            added += QRect(x, y, 8, 8);
+        }
+    }
+    wl_surface_commit(surface);
+    QTRY_COMPARE(damagedSpy.count(), 1);
+    const QRegion surfaceDamage = damagedSpy.first().first().value<QRegion>();
+    QVERIFY((added - surfaceDamage).isEmpty());
+    QCOMPARE(surfaceDamage.boundingRect(), added.boundingRect());
+
+    wl_surface_destroy(surface);
+}
+
+void tst_WaylandCompositor::inputRegion()
+{
+    // Hit-testing gives what QRegion gives
+    const QRegion region = QRegion(0, 0, 100, 100) - QRegion(20, 20, 30, 30) + QRegion(200, 50, 10, 200);
+    QtWayland::InputRegion hitTest(region);
+    for (int y = -5; y < 260; y += 3) {
+        for (int x = -5; x < 220; x += 3)
+            QCOMPARE(hitTest.contains(QPoint(x, y)), region.contains(QPoint(x, y)));
+    }
+    QVERIFY(hitTest.contains(QPointF(19.9, 30)));
+    QVERIFY(!hitTest.contains(QPointF(20.1, 30)));
+    QVERIFY(!QtWayland::InputRegion().contains(QPoint()));
+
+    // Rectangles reaching the limits of int do not overflow
+    const QPoint min(std::numeric_limits<int>::min(), std::numeric_limits<int>::min());
+    const QPoint max(std::numeric_limits<int>::max(), std::numeric_limits<int>::max());
+    const QtWayland::InputRegion infinite(QRegion(QRect(min, max)));
+    QVERIFY(infinite.contains(QPoint(0, 0)));
+    QVERIFY(infinite.contains(min));
+    QVERIFY(infinite.contains(max));
+
+    TestCompositor compositor;
+    QWaylandSoftwareOutput output(&compositor, QSize(320, 240), "", "");
+    compositor.setPrimaryOutput(&output);
+
+    MockClient client;
+    wl_surface *surface = client.createSurface();
+    QTRY_COMPARE(compositor.surfaces.size(), 1);
+    QWaylandSurface *waylandSurface = compositor.surfaces.at(0);
+
+    // Before its first commit a surface takes input everywhere
+    QVERIFY(waylandSurface->inputRegionContains(QPoint(30, 30)));
+
+    QSize size(100, 100);
+    ShmBuffer buffer(size, client.shm);
+    client.createShellSurface(surface);
+    wl_surface_attach(surface, buffer.handle, 0, 0);
+    wl_surface_damage(surface, 0, 0, size.width(), size.height());
+    wl_surface_commit(surface);
+    QTRY_VERIFY(waylandSurface->isMapped());
+
+    // Until the client sets an input region, the whole surface takes input
+    QVERIFY(waylandSurface->inputRegionContains(QPoint(30, 30)));
+    QVERIFY(waylandSurface->inputRegionContains(QPointF(99.5, 0)));
+
+    wl_region *input = wl_compositor_create_region(client.compositor);
+    wl_region_add(input, 0, 0, 100, 100);
+    wl_region_subtract(input, 20, 20, 30, 30);
+    wl_surface_set_input_region(surface, input);
+    wl_region_destroy(input);
+    wl_surface_commit(surface);
+    QTRY_VERIFY(!waylandSurface->inputRegionContains(QPoint(30, 30)));
+
+    QVERIFY(waylandSurface->inputRegionContains(QPoint(10, 10)));
+    QVERIFY(!waylandSurface->inputRegionContains(QPoint(30, 30)));
+    QVERIFY(!waylandSurface->inputRegionContains(QPoint(150, 10)));
+
+    // Picking goes through the holes of the input region
+    QWaylandSurfaceView *view = waylandSurface->views().first();
+    view->setPos(QPointF(50, 50));
+    QCOMPARE(compositor.pickView(QPointF(60, 60)), view);
+    QCOMPARE(compositor.pickView(QPointF(80.5, 80.5)), static_cast<QWaylandSurfaceView *>(0));
+    QCOMPARE(compositor.pickView(QPointF(160, 60)), static_cast<QWaylandSurfaceView *>(0));
+
+    // Without an input region the whole surface takes input
+    wl_surface_set_input_region(surface, NULL);
+    wl_surface_commit(surface);
+    QTRY_VERIFY(waylandSurface->inputRegionContains(QPoint(30, 30)));
+    QCOMPARE(compositor.pickView(QPointF(80.5, 80.5)), view);
+
+    wl_surface_destroy(surface);
+}
+
+#ifdef QT_COMPOSITOR_WAYLAND_GL
+// Small SHM surfaces in a row, 4 pixels apart, drawn by a batch renderer
+// into a 320x240 framebuffer
+class BatchRendererScene
+{
+public:
+    BatchRendererScene()
+        : output(&compositor, Q_NULLPTR, "", "")
+        , renderer(&output)
+    {
+        output.setMode({QSize(320, 240), 60});
+        renderer.setClearColor(Qt::blue);
+    }
+
+    ~BatchRendererScene()
+    {
+        if (QOpenGLContext::currentContext())
+            renderer.releaseResources();
+        foreach (wl_surface *surface, surfaces)
+            wl_surface_destroy(surface);
+        qDeleteAll(buffers);
+    }
+
+    bool makeCurrent()
+    {
+        offscreen.create();
+        if (!context.create() || !context.makeCurrent(&offscreen))
+            return false;
+        fbo.reset(new QOpenGLFramebufferObject(320, 240));
+        return fbo->bind();
+    }
+
+    bool addSurfaces(int count, const QSize &size)
+    {
+        const int first = surfaces.size();
+        for (int i = 0; i < count; ++i) {
+            wl_surface *surface = client.createSurface();
+            ShmBuffer *buffer = new ShmBuffer(size, client.shm);
+            buffer->image.fill(Qt::red);
+            client.createShellSurface(surface);
+            wl_surface_attach(surface, buffer->handle, 0, 0);
+            wl_surface_damage(surface, 0, 0, size.width(), size.height());
+            wl_surface_commit(surface);
+            buffers << buffer;
+            surfaces << surface;
+        }
+
+        QElapsedTimer timeout;
+        timeout.start();
+        while (compositor.surfaces.size() < surfaces.size() && timeout.elapsed() < 5000)
+            QTest::qWait(10);
+        for (int i = first; i < compositor.surfaces.size(); ++i) {
+            QWaylandSurface *surface = compositor.surfaces.at(i);
+            while (!surface->isMapped() && timeout.elapsed() < 5000)
+                QTest::qWait(10);
+            if (!surface->isMapped())
+                return false;
+            QWaylandSurfaceView *view = surface->views().first();
+            view->setPos(QPointF(i * (size.width() + 4), 10));
+            views << view;
+        }
+        return views.size() == surfaces.size();
+    }
+
+    QOffscreenSurface offscreen;
+    QOpenGLContext context;
+    QScopedPointer<QOpenGLFramebufferObject> fbo;
+    TestCompositor compositor;
+    QWaylandOutput output;
+    QWaylandBatchRenderer renderer;
+    MockClient client;
+    QList<ShmBuffer *> buffers;
+    QList<wl_surface *> surfaces;
+    QList<QWaylandSurfaceView *> views;
+};
+
+void tst_WaylandCompositor::batchRendererAtlas()
+{
+    BatchRendererScene scene;
+    if (!scene.makeCurrent())
+        QSKIP("No OpenGL context available");
+    QVERIFY(scene.addSurfaces(12, QSize(16, 16)));
+
+    // All of them share the atlas and are drawn at once
+    scene.renderer.render(scene.views);
+    QCOMPARE(scene.renderer.drawCallCount(), 1);
+    const QImage image = scene.fbo->toImage();
+    QCOMPARE(image.pixel(5, 15), QColor(Qt::red).rgba());
+    QCOMPARE(image.pixel(18, 15), QColor(Qt::blue).rgba());
+    QCOMPARE(image.pixel(225, 15), QColor(Qt::red).rgba());
+}
+
+void tst_WaylandCompositor::batchRendererDamage()
+{
+    BatchRendererScene scene;
+    if (!scene.makeCurrent())
+        QSKIP("No OpenGL context available");
+    QVERIFY(scene.addSurfaces(12, QSize(16, 16)));
+    scene.renderer.render(scene.views);
+
+    // Damage only updates part of the atlas
+    QWaylandSurface *first = scene.compositor.surfaces.at(0);
+    QSignalSpy damagedSpy(first, SIGNAL(damaged(const QRegion &)));
+    scene.buffers.at(0)->image.fill(Qt::green);
+    wl_surface_attach(scene.surfaces.at(0), scene.buffers.at(0)->handle, 0, 0);
+    wl_surface_damage(scene.surfaces.at(0), 0, 0, 4, 4);
+    wl_surface_commit(scene.surfaces.at(0));
+    QTRY_COMPARE(damagedSpy.count(), 1);
+
+    scene.renderer.render(scene.views, QRegion(0, 10, 16, 16));
+    QCOMPARE(scene.renderer.drawCallCount(), 1);
+    const QImage image = scene.fbo->toImage();
+    QCOMPARE(image.pixel(1, 11), QColor(Qt::green).rgba());
+    QCOMPARE(image.pixel(8, 18), QColor(Qt::red).rgba());
+}
+
+void tst_WaylandCompositor::batchRendererLargeSurfaces()
+{
+    BatchRendererScene scene;
+    if (!scene.makeCurrent())
+        QSKIP("No OpenGL context available");
+    QVERIFY(scene.addSurfaces(12, QSize(16, 16)));
+
+    // Surfaces too big for the atlas get a texture and a draw call of their own
+    scene.renderer.setMaxAtlasSurfaceSize(QSize(8, 8));
+    scene.renderer.render(scene.views);
+    QCOMPARE(scene.renderer.drawCallCount(), 12);
+    QCOMPARE(scene.fbo->toImage().pixel(225, 15), QColor(Qt::red).rgba());
+
+    scene.renderer.setMaxAtlasSurfaceSize(QSize(128, 128));
+    scene.renderer.render(scene.views);
+    QCOMPARE(scene.renderer.drawCallCount(), 1);
+}
+
+void tst_WaylandCompositor::batchRendererAtlasOverflow()
+{
+    BatchRendererScene scene;
+    if (!scene.makeCurrent())
+        QSKIP("No OpenGL context available");
+    // Room for 8 of the 12 surfaces
+    scene.renderer.setAtlasSize(QSize(64, 32));
+    QVERIFY(scene.addSurfaces(12, QSize(16, 16)));
+
+    scene.renderer.render(scene.views.mid(0, 8));
+    QCOMPARE(scene.renderer.drawCallCount(), 1);
+
+    // Shown surfaces take the atlas space of hidden ones
+    scene.renderer.render(scene.views.mid(8));
+    QCOMPARE(scene.renderer.drawCallCount(), 1);
+
+    // With more surfaces than fit, the rest get textures of their own. Every
+    // view is drawn, also the ones allocated before the atlas was repacked.
+    for (int frame = 0; frame < 2; ++frame) {
+        scene.renderer.render(scene.views);
+        QCOMPARE(scene.renderer.drawCallCount(), 5);
+        const QImage image = scene.fbo->toImage();
+        for (int i = 0; i < scene.views.size(); ++i)
+            QCOMPARE(image.pixel(i * 20 + 8, 18), QColor(Qt::red).rgba());
+    }
+}
+#endif
+
+void tst_WaylandCompositor::softwareOutputCursor()
+{
+    TestCompositor compositor;
+    QWaylandSoftwareOutput output(&compositor, QSize(320, 240), "", "");
+    output.setClearColor(Qt::blue);
+    compositor.setPrimaryOutput(&output);
+    output.render();
+
+    MockClient client;
+
+    wl_surface *surface = client.createSurface();
+    QTRY_COMPARE(compositor.surfaces.size(), 1);
+    QWaylandSurface *waylandSurface = compositor.surfaces.at(0);
+
+    QSignalSpy renderedSpy(&output, SIGNAL(frameRendered(const QRegion &)));
+
+    output.setCursorSurface(waylandSurface, QPoint(2, 2));
+    output.setCursorPosition(QPoint(50, 50));
+
+    QSize size(16, 16);
+    ShmBuffer buffer(size, client.shm);
+    buffer.image.fill(Qt::green);
+    wl_surface_attach(surface, buffer.handle, 0, 0);
+    wl_surface_damage(surface, 0, 0, size.width(), size.height());
+    wl_surface_commit(surface);
+
+    QTRY_COMPARE(renderedSpy.count(), 1);
+    QCOMPARE(output.cursorGeometry(), QRect(48, 48, 16, 16));
+    QCOMPARE(output.damage(), QRegion(48, 48, 16, 16));
+    QCOMPARE(output.framebuffer().pixel(50, 50), QColor(Qt::green).rgba());
+
+    // Pointer motion moves the cursor, which only repaints the area it left
+    // and the area it enters
+    compositor.defaultInputDevice()->sendMouseMoveEvent(QPointF(), QPointF(100, 100));
+    QCOMPARE(output.cursorPosition(), QPoint(100, 100));
+    QTRY_COMPARE(renderedSpy.count(), 2);
+    QCOMPARE(output.damage(), QRegion(48, 48, 16, 16) + QRegion(98, 98, 16, 16));
+    QCOMPARE(output.framebuffer().pixel(50, 50), QColor(Qt::blue).rgba());
+    QCOMPARE(output.framebuffer().pixel(100, 100), QColor(Qt::green).rgba());
+
+    // Hiding the cursor clears its last area
+    output.setCursorSurface(Q_NULLPTR, QPoint());
+    QTRY_COMPARE(renderedSpy.count(), 3);
+    QCOMPARE(output.damage(), QRegion(98, 98, 16, 16));
+    QCOMPARE(output.framebuffer().pixel(100, 100), QColor(Qt::blue).rgba());
+
+    wl_surface_destroy(surface);
+}
+
+void tst_WaylandCompositor::outputCapture()
+{
+    TestCompositor compositor;
+    QWaylandSoftwareOutput output(&compositor, QSize(320, 240), "", "");
+    compositor.setPrimaryOutput(&output);
+
+    QWaylandOutputCapture capture(&output);
+    QVERIFY(capture.allocateSharedBuffer(output.mode().size));
+    QVERIFY(capture.sharedBufferFd() >= 0);
+    QSignalSpy frameSpy(&capture, SIGNAL(frameReady(const QRegion &)));
+
+    MockClient client;
+
+    wl_surface *surface = client.createSurface();
+    QTRY_COMPARE(compositor.surfaces.size(), 1);
+    QWaylandSurface *waylandSurface = compositor.surfaces.at(0);
+    QSignalSpy damagedSpy(waylandSurface, SIGNAL(damaged(const QRegion &)));
+
+    QSize size(64, 64);
+    ShmBuffer buffer(size, client.shm);
+    buffer.image.fill(Qt::red);
+
+    client.createShellSurface(surface);
+    wl_surface_attach(surface, buffer.handle, 0, 0);
+    wl_surface_damage(surface, 0, 0, size.width(), size.height());
+    wl_surface_commit(surface);
+    QTRY_COMPARE(damagedSpy.count(), 1);
+
+    // The first frame delivers the whole output
+    output.render();
+    QCOMPARE(frameSpy.count(), 1);
+    QCOMPARE(frameSpy.at(0).at(0).value<QRegion>(), QRegion(0, 0, 320, 240));
+    QCOMPARE(capture.image().pixel(10, 10), QColor(Qt::red).rgba());
+    QVERIFY(capture.isBusy());
+
+    // The consumer still holds the buffer, so the next frame is dropped
+    wl_surface_attach(surface, buffer.handle, 0, 0);
+    wl_surface_damage(surface, 0, 0, 4, 4);
+    wl_surface_commit(surface);
+    QTRY_COMPARE(damagedSpy.count(), 2);
+    output.render();
+    QCOMPARE(frameSpy.count(), 1);
+    QCOMPARE(capture.droppedFrames(), 1);
+
+    // Releasing delivers the damage accumulated in the meantime
+    capture.release();
+    QTRY_COMPARE(frameSpy.count(), 2);
+    QCOMPARE(frameSpy.at(1).at(0).value<QRegion>(), QRegion(0, 0, 4, 4));
+
+    wl_surface_destroy(surface);
+}
+
+void tst_WaylandCompositor::batchedFlush()
+{
+    TestCompositor compositor;
+
+    MockClient client;
+
+    client.createSurface();
+    client.createSurface();
+    client.createSurface();
+    QTRY_COMPARE(compositor.surfaces.size(), 3);
+
+    QWaylandClient *waylandClient = compositor.surfaces.at(0)->client();
+    compositor.handle()->flushClients();
+    quint64 flushCount = waylandClient->flushCount();
+
+    // Frame callbacks for several surfaces of the same client result in one flush
+    compositor.frameStarted();
+    compositor.sendFrameCallbacks(compositor.surfaces);
+    compositor.sendFrameCallbacks(compositor.surfaces);
+    QCOMPARE(waylandClient->flushCount(), flushCount);
+
+    compositor.handle()->flushClients();
+    QCOMPARE(waylandClient->flushCount(), flushCount + 1);
+
+    // Nothing left to flush
+    compositor.handle()->flushClients();
+    QCOMPARE(waylandClient->flushCount(), flushCount + 1);
+
+    // Input marks only the client which has the focus
+    MockClient otherClient;
+    otherClient.createSurface();
+    QTRY_COMPARE(compositor.surfaces.size(), 4);
+
+    QWaylandClient *otherWaylandClient = compositor.surfaces.at(3)->client();
+    compositor.handle()->flushClients();
+    flushCount = waylandClient->flushCount();
+    quint64 otherFlushCount = otherWaylandClient->flushCount();
+
+    compositor.defaultInputDevice()->setKeyboardFocus(compositor.surfaces.at(0));
+    compositor.handle()->flushClients();
+    QCOMPARE(waylandClient->flushCount(), flushCount + 1);
+    QCOMPARE(otherWaylandClient->flushCount(), otherFlushCount);
+}
+
 void tst_WaylandCompositor::inputDeviceCapabilities()
 {
     TestCompositor compositor;
@@ -353,6 +1302,180 @@ void tst_WaylandCompositor::inputDeviceCreation()
     QTRY_COMPARE(dev2.queryCount(), 7);
 }
 
+void tst_WaylandCompositor::inputDeviceTouchRouting()
+{
+    TestCompositor compositor;
+    TestInputDevice dev1(&compositor, QWaylandInputDevice::Touch);
+    TestInputDevice dev2(&compositor, QWaylandInputDevice::Touch);
+
+    compositor.handle()->registerInputDevice(&dev1);
+    compositor.handle()->registerInputDevice(&dev2);
+
+    QTouchDevice touchDevice;
+    touchDevice.setType(QTouchDevice::TouchScreen);
+    QTouchEvent begin(QEvent::TouchBegin, &touchDevice);
+    QTouchEvent update(QEvent::TouchUpdate, &touchDevice);
+    QTouchEvent end(QEvent::TouchEnd, &touchDevice);
+
+    // Neither test device claims touch events, so they end up with the default device
+    QCOMPARE(compositor.inputDeviceFor(&begin), compositor.defaultInputDevice());
+    QCOMPARE(dev1.queryCount(), 1);
+    QCOMPARE(dev2.queryCount(), 1);
+
+    // Every device is asked for every event unless the routes are cached
+    QCOMPARE(compositor.inputDeviceFor(&update), compositor.defaultInputDevice());
+    QCOMPARE(dev1.queryCount(), 2);
+    QCOMPARE(dev2.queryCount(), 2);
+
+    compositor.setTouchRouteCacheEnabled(true);
+    QCOMPARE(compositor.inputDeviceFor(&begin), compositor.defaultInputDevice());
+    QCOMPARE(dev1.queryCount(), 3);
+    QCOMPARE(dev2.queryCount(), 3);
+
+    // Further events from the same touch device are routed without asking again
+    QCOMPARE(compositor.inputDeviceFor(&update), compositor.defaultInputDevice());
+    QCOMPARE(compositor.inputDeviceFor(&end), compositor.defaultInputDevice());
+    QCOMPARE(dev1.queryCount(), 3);
+    QCOMPARE(dev2.queryCount(), 3);
+
+    // Registering a device invalidates the routes
+    TestInputDevice dev3(&compositor, QWaylandInputDevice::Touch);
+    compositor.handle()->registerInputDevice(&dev3);
+    QCOMPARE(compositor.inputDeviceFor(&update), compositor.defaultInputDevice());
+    QCOMPARE(dev3.queryCount(), 1);
+    QCOMPARE(dev2.queryCount(), 4);
+}
+
+static QTouchEvent::TouchPoint touchPoint(int id, Qt::TouchPointState state, const QPointF &pos, qreal pressure)
+{
+    QTouchEvent::TouchPoint point(id);
+    point.setState(state);
+    point.setPos(pos);
+    point.setNormalizedPos(QPointF(pos.x() / 64, pos.y() / 64));
+    point.setRect(QRectF(pos - QPointF(2, 2), QSizeF(4, 4)));
+    point.setPressure(pressure);
+    return point;
+}
+
+static void sendTouchFrame(QWaylandInputDevice *input, QTouchDevice *device, QEvent::Type type,
+                           const QList<QTouchEvent::TouchPoint> &points)
+{
+    Qt::TouchPointStates states = 0;
+    foreach (const QTouchEvent::TouchPoint &point, points)
+        states |= point.state();
+    QTouchEvent event(type, device, Qt::NoModifier, states, points);
+    input->sendFullTouchEvent(&event);
+}
+
+void tst_WaylandCompositor::touchFrame()
+{
+    TestCompositor compositor;
+    MockClient client;
+    QVERIFY(client.touchExtension);
+
+    ShmBuffer buffer(QSize(64, 64), client.shm);
+    wl_surface *surface = client.createMappedSurface(buffer);
+    QWaylandSurface *waylandSurface = compositor.waitForMappedSurface();
+    QVERIFY(waylandSurface);
+    QWaylandSurfaceView view(waylandSurface);
+    QWaylandInputDevice *input = compositor.defaultInputDevice();
+    input->setMouseFocus(&view, QPointF());
+
+    QTouchDevice touchDevice;
+    touchDevice.setType(QTouchDevice::TouchScreen);
+    const uint32_t allFields = QT_TOUCH_EXTENSION_FRAME_FIELD_POSITION
+            | QT_TOUCH_EXTENSION_FRAME_FIELD_NORMALIZED_POSITION
+            | QT_TOUCH_EXTENSION_FRAME_FIELD_SIZE
+            | QT_TOUCH_EXTENSION_FRAME_FIELD_PRESSURE
+            | QT_TOUCH_EXTENSION_FRAME_FIELD_VELOCITY
+            | QT_TOUCH_EXTENSION_FRAME_FIELD_RAW_POSITIONS;
+
+    // Pressed points carry every field
+    QTouchEvent::TouchPoint first = touchPoint(1, Qt::TouchPointPressed, QPointF(10, 20), 0.5);
+    first.setRawScreenPositions(QVector<QPointF>() << QPointF(110, 120) << QPointF(111, 121));
+    QTouchEvent::TouchPoint second = touchPoint(2, Qt::TouchPointPressed, QPointF(30, 40), 0.5);
+    sendTouchFrame(input, &touchDevice, QEvent::TouchBegin, QList<QTouchEvent::TouchPoint>() << first << second);
+    QTRY_COMPARE(client.touchFrames.count(), 1);
+    QList<MockClient::TouchFramePoint> frame = client.touchFrames.last();
+    QCOMPARE(frame.count(), 2);
+    QCOMPARE(frame.at(0).id, 1u);
+    QCOMPARE(frame.at(0).state, uint32_t(Qt::TouchPointPressed));
+    QCOMPARE(frame.at(0).fields, allFields);
+    QCOMPARE(frame.at(0).x, 100000);
+    QCOMPARE(frame.at(0).y, 200000);
+    QCOMPARE(frame.at(0).w, 40000);
+    QCOMPARE(frame.at(0).pressure, 127u);
+    QCOMPARE(frame.at(0).rawPositions, first.rawScreenPositions());
+    QCOMPARE(frame.at(1).id, 2u);
+    QCOMPARE(frame.at(1).fields, allFields);
+    QCOMPARE(frame.at(1).x, 300000);
+    QVERIFY(frame.at(1).rawPositions.isEmpty());
+
+    // Stationary points are left out, moved points only carry what changed
+    first.setState(Qt::TouchPointMoved);
+    first.setPos(QPointF(12, 20));
+    second.setState(Qt::TouchPointStationary);
+    sendTouchFrame(input, &touchDevice, QEvent::TouchUpdate, QList<QTouchEvent::TouchPoint>() << first << second);
+    QTRY_COMPARE(client.touchFrames.count(), 2);
+    frame = client.touchFrames.last();
+    QCOMPARE(frame.count(), 1);
+    QCOMPARE(frame.at(0).id, 1u);
+    QCOMPARE(frame.at(0).fields, uint32_t(QT_TOUCH_EXTENSION_FRAME_FIELD_POSITION));
+    QCOMPARE(frame.at(0).x, 120000);
+    QCOMPARE(frame.at(0).y, 200000);
+    QCOMPARE(frame.at(0).nx, 1562);
+    QCOMPARE(frame.at(0).pressure, 127u);
+    QCOMPARE(frame.at(0).rawPositions, first.rawScreenPositions());
+
+    // Each point of a frame has its own field mask
+    first.setPressure(1.0);
+    second.setState(Qt::TouchPointMoved);
+    second.setPos(QPointF(30, 44));
+    second.setNormalizedPos(QPointF(30.0 / 64, 44.0 / 64));
+    sendTouchFrame(input, &touchDevice, QEvent::TouchUpdate, QList<QTouchEvent::TouchPoint>() << first << second);
+    QTRY_COMPARE(client.touchFrames.count(), 3);
+    frame = client.touchFrames.last();
+    QCOMPARE(frame.count(), 2);
+    QCOMPARE(frame.at(0).fields, uint32_t(QT_TOUCH_EXTENSION_FRAME_FIELD_PRESSURE));
+    QCOMPARE(frame.at(0).x, 120000);
+    QCOMPARE(frame.at(0).pressure, 255u);
+    QCOMPARE(frame.at(1).fields, uint32_t(QT_TOUCH_EXTENSION_FRAME_FIELD_POSITION
+                                          | QT_TOUCH_EXTENSION_FRAME_FIELD_NORMALIZED_POSITION));
+    QCOMPARE(frame.at(1).x, 300000);
+    QCOMPARE(frame.at(1).y, 440000);
+    QCOMPARE(frame.at(1).w, 40000);
+    QCOMPARE(frame.at(1).pressure, 127u);
+
+    // Clients drop their points on cancel, so the next frame starts over
+    input->sendTouchCancelEvent();
+    sendTouchFrame(input, &touchDevice, QEvent::TouchUpdate, QList<QTouchEvent::TouchPoint>() << first << second);
+    QTRY_COMPARE(client.touchFrames.count(), 4);
+    frame = client.touchFrames.last();
+    QCOMPARE(frame.count(), 2);
+    QCOMPARE(frame.at(0).fields, allFields);
+    QCOMPARE(frame.at(1).fields, allFields);
+
+    // Released points without changes carry no fields and are forgotten
+    first.setState(Qt::TouchPointReleased);
+    second.setState(Qt::TouchPointReleased);
+    sendTouchFrame(input, &touchDevice, QEvent::TouchEnd, QList<QTouchEvent::TouchPoint>() << first << second);
+    QTRY_COMPARE(client.touchFrames.count(), 5);
+    frame = client.touchFrames.last();
+    QCOMPARE(frame.count(), 2);
+    QCOMPARE(frame.at(0).state, uint32_t(Qt::TouchPointReleased));
+    QCOMPARE(frame.at(0).fields, 0u);
+    QCOMPARE(frame.at(0).x, 120000);
+    QCOMPARE(frame.at(1).fields, 0u);
+    QCOMPARE(frame.at(1).y, 440000);
+
+    first.setState(Qt::TouchPointMoved);
+    sendTouchFrame(input, &touchDevice, QEvent::TouchUpdate, QList<QTouchEvent::TouchPoint>() << first);
+    QTRY_COMPARE(client.touchFrames.count(), 6);
+    QCOMPARE(client.touchFrames.last().at(0).fields, allFields);
+
+    wl_surface_destroy(surface);
+}
+
 void tst_WaylandCompositor::inputDeviceKeyboardFocus()
 {
     TestCompositor compositor;
@@ -391,5 +1514,67 @@ void tst_WaylandCompositor::inputDeviceKeyboardFocus()
    QTRY_VERIFY(!dev2.keyboardFocus());
 }
 
+void tst_WaylandCompositor::propertyCodec()
+{
+    QList<QVariant> values;
+    values << QVariant(42) << QVariant(-7) << QVariant(true) << QVariant(0.25)
+           << QVariant(QStringLiteral("odd")) << QVariant(QString())
+           << QVariant(QPoint(3, 4)) << QVariant(QStringList() << "a" << "bc");
+
+    // All records are batched into one array
+    QByteArray data;
+    for (int i = 0; i < values.size(); ++i)
+        QWaylandPropertyCodec::encode(data, i + 1, values.at(i));
+    QCOMPARE(data.size() % 4, 0);
+
+    int offset = 0;
+    for (int i = 0; i < values.size(); ++i) {
+        uint id = 0;
+        QVariant value;
+        QVERIFY(QWaylandPropertyCodec::decode(data, offset, id, value));
+        QCOMPARE(id, uint(i + 1));
+        QCOMPARE(value, values.at(i));
+    }
+    QCOMPARE(offset, data.size());
+
+    // Truncated records are rejected
+    QByteArray truncated = data.left(data.size() - 4);
+    offset = 0;
+    uint id;
+    QVariant value;
+    bool ok = true;
+    while (ok && offset < truncated.size())
+        ok = QWaylandPropertyCodec::decode(truncated, offset, id, value);
+    QVERIFY(!ok);
+}
+
+#ifndef QT_NO_WAYLAND_XKB
+void tst_WaylandCompositor::xkbKeysymToQtKey()
+{
+    Qt::KeyboardModifiers modifiers = Qt::NoModifier;
+    QCOMPARE(QWaylandXkb::keysymToQtKey(XKB_KEY_Escape, modifiers, QString()), int(Qt::Key_Escape));
+    QCOMPARE(QWaylandXkb::keysymToQtKey(XKB_KEY_XF86Eject, modifiers, QString()), int(Qt::Key_Eject));
+    QCOMPARE(QWaylandXkb::keysymToQtKey(XKB_KEY_Clear, modifiers, QString()), int(Qt::Key_Delete));
+    QCOMPARE(modifiers, Qt::NoModifier);
+    QCOMPARE(QWaylandXkb::keysymToQtKey(XKB_KEY_KP_Home, modifiers, QString()), int(Qt::Key_Home));
+    QCOMPARE(modifiers, Qt::KeypadModifier);
+    modifiers = Qt::NoModifier;
+    QCOMPARE(QWaylandXkb::keysymToQtKey(0x1234567, modifiers, QString()), 0);
+}
+
+void tst_WaylandCompositor::xkbQtKeyToKeysym()
+{
+    QCOMPARE(QWaylandXkb::qtKeyToKeysym(Qt::Key_Escape, Qt::NoModifier), xkb_keysym_t(XKB_KEY_Escape));
+    QCOMPARE(QWaylandXkb::qtKeyToKeysym(Qt::Key_Delete, Qt::NoModifier), xkb_keysym_t(XKB_KEY_Delete));
+    QCOMPARE(QWaylandXkb::qtKeyToKeysym(Qt::Key_Home, Qt::NoModifier), xkb_keysym_t(XKB_KEY_Home));
+    QCOMPARE(QWaylandXkb::qtKeyToKeysym(Qt::Key_Home, Qt::KeypadModifier), xkb_keysym_t(XKB_KEY_KP_Home));
+    QCOMPARE(QWaylandXkb::qtKeyToKeysym(Qt::Key_7, Qt::KeypadModifier), xkb_keysym_t(XKB_KEY_KP_7));
+    QCOMPARE(QWaylandXkb::qtKeyToKeysym(Qt::Key_F12, Qt::NoModifier), xkb_keysym_t(XKB_KEY_F12));
+    QCOMPARE(QWaylandXkb::qtKeyToKeysym(Qt::Key_A, Qt::NoModifier), xkb_keysym_t(XKB_KEY_a));
+    QCOMPARE(QWaylandXkb::qtKeyToKeysym(Qt::Key_A, Qt::ShiftModifier), xkb_keysym_t(XKB_KEY_A));
+    QCOMPARE(QWaylandXkb::qtKeyToKeysym(Qt::Key_Space, Qt::NoModifier), xkb_keysym_t(XKB_KEY_space));
+}
+#endif
+
 #include <tst_compositor.moc>
 QTEST_MAIN(tst_WaylandCompositor);